@@ -62,6 +62,9 @@ struct FSTEntry {
 // Overloaded GetSize, accepts FILE*
 [[nodiscard]] u64 GetSize(FILE* f);
 
+// Returns the last modification time of filename in seconds since the epoch, or 0 on failure
+[[nodiscard]] s64 GetLastWriteTime(const std::string& filename);
+
 // Returns true if successful, or path already exists.
 bool CreateDir(const std::string& filename);
 
@@ -295,4 +298,33 @@ private:
     std::FILE* m_file = nullptr;
 };
 
+// A read-only mapping of an entire file into the address space. Reads from the mapping are plain
+// memory accesses, so unlike IOFile it can be read from multiple threads at once.
+class MappedFile : public NonCopyable {
+public:
+    MappedFile();
+    explicit MappedFile(const std::string& filename);
+
+    ~MappedFile();
+
+    bool Open(const std::string& filename);
+    void Close();
+
+    [[nodiscard]] bool IsOpen() const {
+        return nullptr != m_data;
+    }
+
+    [[nodiscard]] const u8* GetData() const {
+        return m_data;
+    }
+
+    [[nodiscard]] std::size_t GetSize() const {
+        return m_size;
+    }
+
+private:
+    const u8* m_data = nullptr;
+    std::size_t m_size = 0;
+};
+
 } // namespace Common::FS
@@ -56,4 +56,18 @@ namespace Common::Compression {
 [[nodiscard]] std::vector<u8> DecompressDataLZ4(const std::vector<u8>& compressed,
                                                 std::size_t uncompressed_size);
 
+/**
+ * Decompresses a source memory region with LZ4 into a caller-provided destination buffer.
+ *
+ * @param source            The compressed source memory region.
+ * @param source_size       The size of the compressed source memory region.
+ * @param destination       The buffer the data is decompressed into.
+ * @param uncompressed_size The size in bytes of the uncompressed data, at most the size of the
+ *                          destination buffer.
+ *
+ * @return true if exactly uncompressed_size bytes were decompressed.
+ */
+[[nodiscard]] bool DecompressDataLZ4(const u8* source, std::size_t source_size, u8* destination,
+                                     std::size_t uncompressed_size);
+
 } // namespace Common::Compression
\ No newline at end of file
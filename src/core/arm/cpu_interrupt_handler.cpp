@@ -12,14 +12,21 @@ CPUInterruptHandler::CPUInterruptHandler() : interrupt_event{std::make_unique<Co
 CPUInterruptHandler::~CPUInterruptHandler() = default;
 
 void CPUInterruptHandler::SetInterrupt(bool is_interrupted_) {
+    // Publish the flag before waking the core so a parked core never observes a wake-up without
+    // the interrupt that caused it. Clearing also drops any wake-up that was never waited on, so
+    // that a stale signal doesn't bounce the core out of its next park.
+    is_interrupted = is_interrupted_;
     if (is_interrupted_) {
         interrupt_event->Set();
+    } else {
+        interrupt_event->Reset();
     }
-    is_interrupted = is_interrupted_;
 }
 
 void CPUInterruptHandler::AwaitInterrupt() {
-    interrupt_event->Wait();
+    while (!is_interrupted) {
+        interrupt_event->Wait();
+    }
 }
 
 } // namespace Core
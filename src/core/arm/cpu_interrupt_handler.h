@@ -30,6 +30,8 @@ public:
 
     void SetInterrupt(bool is_interrupted);
 
+    /// Parks the calling host thread until the core is interrupted. Returns immediately if an
+    /// interrupt is already pending.
     void AwaitInterrupt();
 
 private:
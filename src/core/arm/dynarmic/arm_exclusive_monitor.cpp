@@ -4,34 +4,81 @@
 
 #include <cinttypes>
 #include <memory>
+#include <type_traits>
 #include "core/arm/dynarmic/arm_exclusive_monitor.h"
 #include "core/memory.h"
 
 namespace Core {
 
+namespace {
+template <typename T>
+u128 ToReservationValue(T value) {
+    if constexpr (std::is_same_v<T, u128>) {
+        return value;
+    } else {
+        return {static_cast<u64>(value), 0};
+    }
+}
+
+template <typename T>
+T FromReservationValue(const u128& value) {
+    if constexpr (std::is_same_v<T, u128>) {
+        return value;
+    } else {
+        return static_cast<T>(value[0]);
+    }
+}
+} // Anonymous namespace
+
 DynarmicExclusiveMonitor::DynarmicExclusiveMonitor(Memory::Memory& memory, std::size_t core_count)
-    : monitor(core_count), memory{memory} {}
+    : monitor(core_count), reservations(core_count), memory{memory} {}
 
 DynarmicExclusiveMonitor::~DynarmicExclusiveMonitor() = default;
 
+template <typename T, typename ReadFunction>
+T DynarmicExclusiveMonitor::ReadAndReserve(std::size_t core_index, VAddr addr,
+                                           ReadFunction&& read) {
+    const T value = read();
+    Reservation& reservation = reservations[core_index];
+    reservation.address = addr;
+    reservation.value = ToReservationValue(value);
+    reservation.is_valid.store(true, std::memory_order_release);
+    return value;
+}
+
+template <typename T, typename WriteFunction>
+bool DynarmicExclusiveMonitor::WriteIfReserved(std::size_t core_index, VAddr addr,
+                                               WriteFunction&& write) {
+    Reservation& reservation = reservations[core_index];
+    if (!reservation.is_valid.exchange(false, std::memory_order_acquire) ||
+        reservation.address != addr) {
+        return false;
+    }
+    // Reservations taken by the JIT are not cleared, as that would take the global monitor lock
+    // and fail pending exclusive writes of other cores to unrelated addresses. The JIT resolves
+    // its exclusive writes with a compare-and-swap as well, so these still fail if this write
+    // changed the value they observed.
+    return write(FromReservationValue<T>(reservation.value));
+}
+
 u8 DynarmicExclusiveMonitor::ExclusiveRead8(std::size_t core_index, VAddr addr) {
-    return monitor.ReadAndMark<u8>(core_index, addr, [&]() -> u8 { return memory.Read8(addr); });
+    return ReadAndReserve<u8>(core_index, addr, [&] { return memory.Read8(addr); });
 }
 
 u16 DynarmicExclusiveMonitor::ExclusiveRead16(std::size_t core_index, VAddr addr) {
-    return monitor.ReadAndMark<u16>(core_index, addr, [&]() -> u16 { return memory.Read16(addr); });
+    return ReadAndReserve<u16>(core_index, addr, [&] { return memory.Read16(addr); });
 }
 
 u32 DynarmicExclusiveMonitor::ExclusiveRead32(std::size_t core_index, VAddr addr) {
-    return monitor.ReadAndMark<u32>(core_index, addr, [&]() -> u32 { return memory.Read32(addr); });
+    return ReadAndReserve<u32>(core_index, addr, [&] { return memory.Read32(addr); });
 }
 
 u64 DynarmicExclusiveMonitor::ExclusiveRead64(std::size_t core_index, VAddr addr) {
-    return monitor.ReadAndMark<u64>(core_index, addr, [&]() -> u64 { return memory.Read64(addr); });
+    return ReadAndReserve<u64>(core_index, addr, [&] { return memory.Read64(addr); });
 }
 
 u128 DynarmicExclusiveMonitor::ExclusiveRead128(std::size_t core_index, VAddr addr) {
-    return monitor.ReadAndMark<u128>(core_index, addr, [&]() -> u128 {
+    return ReadAndReserve<u128>(core_index, addr, [&] {
         u128 result;
         result[0] = memory.Read64(addr);
         result[1] = memory.Read64(addr + 8);
@@ -40,35 +87,38 @@ u128 DynarmicExclusiveMonitor::ExclusiveRead128(std::size_t core_index, VAddr ad
 }
 
 void DynarmicExclusiveMonitor::ClearExclusive() {
+    for (auto& reservation : reservations) {
+        reservation.is_valid.store(false, std::memory_order_relaxed);
+    }
     monitor.Clear();
 }
 
 bool DynarmicExclusiveMonitor::ExclusiveWrite8(std::size_t core_index, VAddr vaddr, u8 value) {
-    return monitor.DoExclusiveOperation<u8>(core_index, vaddr, [&](u8 expected) -> bool {
+    return WriteIfReserved<u8>(core_index, vaddr, [&](u8 expected) {
         return memory.WriteExclusive8(vaddr, value, expected);
     });
 }
 
 bool DynarmicExclusiveMonitor::ExclusiveWrite16(std::size_t core_index, VAddr vaddr, u16 value) {
-    return monitor.DoExclusiveOperation<u16>(core_index, vaddr, [&](u16 expected) -> bool {
+    return WriteIfReserved<u16>(core_index, vaddr, [&](u16 expected) {
         return memory.WriteExclusive16(vaddr, value, expected);
     });
 }
 
 bool DynarmicExclusiveMonitor::ExclusiveWrite32(std::size_t core_index, VAddr vaddr, u32 value) {
-    return monitor.DoExclusiveOperation<u32>(core_index, vaddr, [&](u32 expected) -> bool {
+    return WriteIfReserved<u32>(core_index, vaddr, [&](u32 expected) {
         return memory.WriteExclusive32(vaddr, value, expected);
     });
 }
 
 bool DynarmicExclusiveMonitor::ExclusiveWrite64(std::size_t core_index, VAddr vaddr, u64 value) {
-    return monitor.DoExclusiveOperation<u64>(core_index, vaddr, [&](u64 expected) -> bool {
+    return WriteIfReserved<u64>(core_index, vaddr, [&](u64 expected) {
         return memory.WriteExclusive64(vaddr, value, expected);
     });
 }
 
 bool DynarmicExclusiveMonitor::ExclusiveWrite128(std::size_t core_index, VAddr vaddr, u128 value) {
-    return monitor.DoExclusiveOperation<u128>(core_index, vaddr, [&](u128 expected) -> bool {
+    return WriteIfReserved<u128>(core_index, vaddr, [&](u128 expected) {
         return memory.WriteExclusive128(vaddr, value, expected);
     });
 }
@@ -4,8 +4,10 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 #include <dynarmic/exclusive_monitor.h>
 
@@ -39,9 +41,29 @@ public:
     bool ExclusiveWrite128(std::size_t core_index, VAddr vaddr, u128 value) override;
 
 private:
+    /**
+     * Reservation taken through this interface by HLE code. The address and value are only
+     * touched by the owning core, and exclusive writes are resolved with a compare-and-swap
+     * against the value observed by the exclusive read, so no lock needs to be shared between
+     * cores. Other cores may only clear the reservation.
+     */
+    struct Reservation {
+        VAddr address{};
+        u128 value{};
+        std::atomic_bool is_valid{};
+    };
+
+    template <typename T, typename ReadFunction>
+    T ReadAndReserve(std::size_t core_index, VAddr addr, ReadFunction&& read);
+
+    template <typename T, typename WriteFunction>
+    bool WriteIfReserved(std::size_t core_index, VAddr addr, WriteFunction&& write);
+
     friend class ARM_Dynarmic_32;
     friend class ARM_Dynarmic_64;
+    /// Monitor used by guest code running in the JIT.
     Dynarmic::ExclusiveMonitor monitor;
+    std::vector<Reservation> reservations;
     Core::Memory::Memory& memory;
 };
 
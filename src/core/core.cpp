@@ -3,13 +3,16 @@
 // Refer to the license.txt file included.
 
 #include <array>
+#include <atomic>
 #include <memory>
+#include <thread>
 #include <utility>
 
 #include "common/file_util.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
 #include "common/string_util.h"
+#include "common/thread.h"
 #include "core/arm/exclusive_monitor.h"
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -17,12 +20,15 @@
 #include "core/device_memory.h"
 #include "core/file_sys/bis_factory.h"
 #include "core/file_sys/card_image.h"
+#include "core/file_sys/container_cache.h"
+#include "core/file_sys/content_archive.h"
 #include "core/file_sys/mode.h"
 #include "core/file_sys/patch_manager.h"
 #include "core/file_sys/registered_cache.h"
 #include "core/file_sys/romfs_factory.h"
 #include "core/file_sys/savedata_factory.h"
 #include "core/file_sys/sdmc_factory.h"
+#include "core/file_sys/submission_package.h"
 #include "core/file_sys/vfs_concat.h"
 #include "core/file_sys/vfs_real.h"
 #include "core/hardware_interrupt_manager.h"
@@ -128,6 +134,20 @@ FileSys::VirtualFile GetGameFileFromPath(const FileSys::VirtualFilesystem& vfs,
     return vfs->OpenFile(path, FileSys::Mode::Read);
 }
 
+static std::vector<std::shared_ptr<FileSys::NCA>> GetNCAsFromGameFile(
+    const FileSys::VirtualFile& file) {
+    switch (Loader::IdentifyFile(file)) {
+    case Loader::FileType::NCA:
+        return {std::make_shared<FileSys::NCA>(file)};
+    case Loader::FileType::NSP:
+        return FileSys::OpenNSP(file)->GetNCAsCollapsed();
+    case Loader::FileType::XCI:
+        return FileSys::OpenXCI(file)->GetSecurePartitionNSP()->GetNCAsCollapsed();
+    default:
+        return {};
+    }
+}
+
 struct System::Impl {
     explicit Impl(System& system)
         : kernel{system}, fs_controller{system}, memory{system},
@@ -274,10 +294,57 @@ struct System::Impl {
         GetAndResetPerfStats();
         perf_stats->BeginSystemFrame();
 
+        if (Settings::values.verify_content_on_load) {
+            StartContentVerification(filepath);
+        }
+
         status = ResultStatus::Success;
         return status;
     }
 
+    /// Checks the hashes of the loaded game's NCAs on a worker thread. The game file is opened
+    /// through a separate filesystem, as RealVfsFilesystem shares one host handle per path and
+    /// the emulated title reads from that handle at the same time.
+    void StartContentVerification(const std::string& filepath) {
+        StopContentVerification();
+        stop_content_verification = false;
+        content_verification_thread = std::thread([this, filepath] {
+            Common::SetCurrentThreadName("yuzu:ContentVerification");
+
+            const auto vfs = std::make_shared<FileSys::RealVfsFilesystem>();
+            const auto should_continue = [this](std::size_t, std::size_t) {
+                return !stop_content_verification.load(std::memory_order_relaxed);
+            };
+
+            std::size_t num_failed = 0;
+            for (const auto& nca : GetNCAsFromGameFile(GetGameFileFromPath(vfs, filepath))) {
+                if (nca->GetStatus() != Loader::ResultStatus::Success) {
+                    continue;
+                }
+                if (!nca->VerifyIntegrity(should_continue)) {
+                    if (stop_content_verification) {
+                        return;
+                    }
+                    ++num_failed;
+                }
+            }
+
+            if (num_failed != 0) {
+                LOG_ERROR(Core, "{} NCA(s) of {} failed content verification", num_failed,
+                          filepath);
+            } else {
+                LOG_INFO(Core, "Content verification of {} passed", filepath);
+            }
+        });
+    }
+
+    void StopContentVerification() {
+        stop_content_verification = true;
+        if (content_verification_thread.joinable()) {
+            content_verification_thread.join();
+        }
+    }
+
     void Shutdown() {
         // Log last frame performance stats if game was loded
         if (perf_stats) {
@@ -294,6 +361,7 @@ struct System::Impl {
         }
 
         lm_manager.Flush();
+        StopContentVerification();
 
         is_powered_on = false;
         exit_lock = false;
@@ -391,6 +459,9 @@ struct System::Impl {
     std::unique_ptr<Tools::Freezer> memory_freezer;
     std::array<u8, 0x20> build_id{};
 
+    std::thread content_verification_thread;
+    std::atomic_bool stop_content_verification{};
+
     /// Frontend applets
     Service::AM::Applets::AppletManager applet_manager;
 
@@ -73,7 +73,10 @@ void AESCipher<Key, KeySize>::Transcode(const u8* src, std::size_t size, u8* des
     mbedtls_cipher_reset(context);
 
     std::size_t written = 0;
-    if (mbedtls_cipher_get_cipher_mode(context) == MBEDTLS_MODE_XTS) {
+    const auto cipher_mode = mbedtls_cipher_get_cipher_mode(context);
+    if (cipher_mode == MBEDTLS_MODE_XTS || cipher_mode == MBEDTLS_MODE_CTR) {
+        // Neither mode needs to be fed block by block. Passing the whole buffer at once lets
+        // mbedtls generate the CTR counter blocks in bulk, and allows in-place transcoding.
         mbedtls_cipher_update(context, src, size, dest, &written);
         if (written != size) {
             LOG_WARNING(Crypto, "Not all data was decrypted requested={:016X}, actual={:016X}.",
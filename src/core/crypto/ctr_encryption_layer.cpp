@@ -3,6 +3,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
 #include <cstring>
 #include "common/assert.h"
 #include "core/crypto/ctr_encryption_layer.h"
@@ -11,44 +12,73 @@ namespace Core::Crypto {
 
 CTREncryptionLayer::CTREncryptionLayer(FileSys::VirtualFile base_, Key128 key_,
                                        std::size_t base_offset)
-    : EncryptionLayer(std::move(base_)), base_offset(base_offset), cipher(key_, Mode::CTR) {}
+    : EncryptionLayer(std::move(base_)), key(key_), base_offset(base_offset) {}
 
 std::size_t CTREncryptionLayer::Read(u8* data, std::size_t length, std::size_t offset) const {
     if (length == 0)
         return 0;
 
+    auto cipher = AcquireCipher();
+    std::size_t total_read = 0;
+
+    // offset does not fall on block boundary (0x10), decrypt the first block separately
     const auto sector_offset = offset & 0xF;
-    if (sector_offset == 0) {
-        UpdateIV(base_offset + offset);
-        std::vector<u8> raw = base->ReadBytes(length, offset);
-        cipher.Transcode(raw.data(), raw.size(), data, Op::Decrypt);
-        return length;
-    }
+    if (sector_offset != 0) {
+        std::array<u8, 0x10> block{};
+        base->Read(block.data(), block.size(), offset - sector_offset);
+        Decrypt(*cipher, block.data(), block.size(), offset - sector_offset);
 
-    // offset does not fall on block boundary (0x10)
-    std::vector<u8> block = base->ReadBytes(0x10, offset - sector_offset);
-    UpdateIV(base_offset + offset - sector_offset);
-    cipher.Transcode(block.data(), block.size(), block.data(), Op::Decrypt);
-    std::size_t read = 0x10 - sector_offset;
+        const std::size_t read = std::min<std::size_t>(length, block.size() - sector_offset);
+        std::memcpy(data, block.data() + sector_offset, read);
+        if (read == length) {
+            ReleaseCipher(std::move(cipher));
+            return read;
+        }
 
-    if (length + sector_offset < 0x10) {
-        std::memcpy(data, block.data() + sector_offset, std::min<u64>(length, read));
-        return std::min<u64>(length, read);
+        data += read;
+        length -= read;
+        offset += read;
+        total_read = read;
     }
-    std::memcpy(data, block.data() + sector_offset, read);
-    return read + Read(data + read, length - read, offset + read);
+
+    // The remainder is block aligned and can be decrypted in place in the caller's buffer.
+    const std::size_t raw_read = base->Read(data, length, offset);
+    Decrypt(*cipher, data, raw_read, offset);
+    ReleaseCipher(std::move(cipher));
+    return total_read + raw_read;
 }
 
 void CTREncryptionLayer::SetIV(const IVData& iv_) {
     iv = iv_;
 }
 
-void CTREncryptionLayer::UpdateIV(std::size_t offset) const {
-    offset >>= 4;
+std::unique_ptr<CTREncryptionLayer::Cipher> CTREncryptionLayer::AcquireCipher() const {
+    {
+        std::lock_guard lock{cipher_mutex};
+        if (!free_ciphers.empty()) {
+            auto cipher = std::move(free_ciphers.back());
+            free_ciphers.pop_back();
+            return cipher;
+        }
+    }
+    return std::make_unique<Cipher>(key, Mode::CTR);
+}
+
+void CTREncryptionLayer::ReleaseCipher(std::unique_ptr<Cipher> cipher) const {
+    std::lock_guard lock{cipher_mutex};
+    free_ciphers.push_back(std::move(cipher));
+}
+
+void CTREncryptionLayer::Decrypt(Cipher& cipher, u8* data, std::size_t length,
+                                 std::size_t offset) const {
+    // The upper half of the IV is fixed, the lower half is the block index.
+    auto counter = iv;
+    std::size_t block_index = (base_offset + offset) >> 4;
     for (std::size_t i = 0; i < 8; ++i) {
-        iv[16 - i - 1] = offset & 0xFF;
-        offset >>= 8;
+        counter[16 - i - 1] = block_index & 0xFF;
+        block_index >>= 8;
     }
-    cipher.SetIV(iv);
+    cipher.SetIV(counter);
+    cipher.Transcode(data, length, data, Op::Decrypt);
 }
 } // namespace Core::Crypto
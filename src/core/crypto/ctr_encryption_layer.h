@@ -5,6 +5,9 @@
 #pragma once
 
 #include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #include "core/crypto/aes_util.h"
 #include "core/crypto/encryption_layer.h"
@@ -24,13 +27,21 @@ public:
     void SetIV(const IVData& iv);
 
 private:
-    std::size_t base_offset;
+    using Cipher = AESCipher<Key128>;
+
+    // Each read decrypts with a cipher context of its own, so that a layer shared by several
+    // files can be read from several threads at once. Contexts are kept for reuse afterwards.
+    std::unique_ptr<Cipher> AcquireCipher() const;
+    void ReleaseCipher(std::unique_ptr<Cipher> cipher) const;
 
-    // Must be mutable as operations modify cipher contexts.
-    mutable AESCipher<Key128> cipher;
-    mutable IVData iv{};
+    void Decrypt(Cipher& cipher, u8* data, std::size_t length, std::size_t offset) const;
+
+    Key128 key;
+    std::size_t base_offset;
+    IVData iv{};
 
-    void UpdateIV(std::size_t offset) const;
+    mutable std::mutex cipher_mutex;
+    mutable std::vector<std::unique_ptr<Cipher>> free_ciphers;
 };
 
 } // namespace Core::Crypto
@@ -6,17 +6,19 @@
 #include <array>
 #include <bitset>
 #include <cctype>
+#include <cstring>
 #include <fstream>
 #include <locale>
 #include <map>
 #include <sstream>
 #include <string_view>
 #include <tuple>
+#include <type_traits>
 #include <vector>
 #include <mbedtls/bignum.h>
 #include <mbedtls/cipher.h>
 #include <mbedtls/cmac.h>
-#include <mbedtls/sha256.h>
+#include "common/cityhash.h"
 #include "common/common_funcs.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
@@ -26,6 +28,7 @@
 #include "core/crypto/aes_util.h"
 #include "core/crypto/key_manager.h"
 #include "core/crypto/partition_data_manager.h"
+#include "core/crypto/sha_util.h"
 #include "core/file_sys/content_archive.h"
 #include "core/file_sys/nca_metadata.h"
 #include "core/file_sys/partition_filesystem.h"
@@ -124,10 +127,56 @@ constexpr KeyArray KEYS_VARIABLE_LENGTH{{
     {{S128KeyType::KeyblobMAC, 0}, "keyblob_mac_key_"},
 }};
 
+constexpr u32 KEY_CACHE_MAGIC = Common::MakeMagic('K', 'E', 'Y', 'C');
+constexpr u32 KEY_CACHE_VERSION = 1;
+constexpr char KEY_CACHE_FILENAME[] = "keys.cache";
+
 template <std::size_t Size>
 bool IsAllZeroArray(const std::array<u8, Size>& array) {
     return std::all_of(array.begin(), array.end(), [](const auto& elem) { return elem == 0; });
 }
+
+// A key file is read from the first directory it exists in.
+struct KeyFileLocation {
+    std::string dir1;
+    std::string dir2;
+    std::string filename;
+    bool title;
+};
+
+// Hashes the paths, sizes and modification times of the key files that would be read.
+u64 HashKeyFiles(const std::vector<KeyFileLocation>& locations) {
+    std::string state;
+    for (const auto& location : locations) {
+        for (const auto& dir : {location.dir1, location.dir2}) {
+            const auto path = dir + DIR_SEP + location.filename;
+            if (Common::FS::Exists(path)) {
+                state += fmt::format("{}:{}:{};", path, Common::FS::GetSize(path),
+                                     Common::FS::GetLastWriteTime(path));
+                break;
+            }
+        }
+    }
+    return Common::CityHash64(state.data(), state.size());
+}
+
+template <typename T>
+void AppendObject(std::vector<u8>& out, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>, "Data type must be trivially copyable.");
+    const auto* bytes = reinterpret_cast<const u8*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+bool ReadObject(const std::vector<u8>& in, std::size_t& position, T& value) {
+    static_assert(std::is_trivially_copyable_v<T>, "Data type must be trivially copyable.");
+    if (sizeof(T) > in.size() - position) {
+        return false;
+    }
+    std::memcpy(&value, in.data() + position, sizeof(T));
+    position += sizeof(T);
+    return true;
+}
 } // Anonymous namespace
 
 u64 GetSignatureTypeDataSize(SignatureType type) {
@@ -476,7 +525,8 @@ static std::array<u8, target_size> MGF1(const std::array<u8, in_size>& seed) {
     while (out.size() < target_size) {
         out.resize(out.size() + 0x20);
         seed_exp[in_size + 3] = static_cast<u8>(i);
-        mbedtls_sha256_ret(seed_exp.data(), seed_exp.size(), out.data() + out.size() - 0x20, 0);
+        const auto hash = CalculateSHA256(seed_exp.data(), seed_exp.size());
+        std::memcpy(out.data() + out.size() - hash.size(), hash.data(), hash.size());
         ++i;
     }
 
@@ -569,20 +619,125 @@ KeyManager::KeyManager() {
     // Initialize keys
     const std::string hactool_keys_dir = Common::FS::GetHactoolConfigurationPath();
     const std::string yuzu_keys_dir = Common::FS::GetUserPath(Common::FS::UserPath::KeysDir);
-    if (Settings::values.use_dev_keys) {
-        dev_mode = true;
-        AttemptLoadKeyFile(yuzu_keys_dir, hactool_keys_dir, "dev.keys", false);
-        AttemptLoadKeyFile(yuzu_keys_dir, yuzu_keys_dir, "dev.keys_autogenerated", false);
-    } else {
-        dev_mode = false;
-        AttemptLoadKeyFile(yuzu_keys_dir, hactool_keys_dir, "prod.keys", false);
-        AttemptLoadKeyFile(yuzu_keys_dir, yuzu_keys_dir, "prod.keys_autogenerated", false);
-    }
-
-    AttemptLoadKeyFile(yuzu_keys_dir, hactool_keys_dir, "title.keys", true);
-    AttemptLoadKeyFile(yuzu_keys_dir, yuzu_keys_dir, "title.keys_autogenerated", true);
-    AttemptLoadKeyFile(yuzu_keys_dir, hactool_keys_dir, "console.keys", false);
-    AttemptLoadKeyFile(yuzu_keys_dir, yuzu_keys_dir, "console.keys_autogenerated", false);
+    dev_mode = Settings::values.use_dev_keys;
+    const std::string standard_keys = dev_mode ? "dev.keys" : "prod.keys";
+
+    const std::vector<KeyFileLocation> locations{
+        {yuzu_keys_dir, hactool_keys_dir, standard_keys, false},
+        {yuzu_keys_dir, yuzu_keys_dir, standard_keys + "_autogenerated", false},
+        {yuzu_keys_dir, hactool_keys_dir, "title.keys", true},
+        {yuzu_keys_dir, yuzu_keys_dir, "title.keys_autogenerated", true},
+        {yuzu_keys_dir, hactool_keys_dir, "console.keys", false},
+        {yuzu_keys_dir, yuzu_keys_dir, "console.keys_autogenerated", false},
+    };
+
+    // Parsing the key files, title keys in particular, takes a while, so the parsed keys are kept
+    // until any of the files change.
+    const auto cache_path = yuzu_keys_dir + DIR_SEP + KEY_CACHE_FILENAME;
+    const auto input_hash = HashKeyFiles(locations);
+    if (LoadKeyCache(cache_path, input_hash)) {
+        return;
+    }
+
+    for (const auto& location : locations) {
+        AttemptLoadKeyFile(location.dir1, location.dir2, location.filename, location.title);
+    }
+    WriteKeyCache(cache_path, input_hash);
+}
+
+bool KeyManager::LoadKeyCache(const std::string& path, u64 input_hash) {
+    const Common::FS::IOFile file{path, "rb"};
+    if (!file.IsOpen()) {
+        return false;
+    }
+
+    std::vector<u8> data(file.GetSize());
+    if (file.ReadBytes(data.data(), data.size()) != data.size()) {
+        return false;
+    }
+
+    std::size_t position = 0;
+    u32 magic{};
+    u32 version{};
+    u64 hash{};
+    u64 num_s128_keys{};
+    if (!ReadObject(data, position, magic) || magic != KEY_CACHE_MAGIC ||
+        !ReadObject(data, position, version) || version != KEY_CACHE_VERSION ||
+        !ReadObject(data, position, hash) || hash != input_hash ||
+        !ReadObject(data, position, num_s128_keys)) {
+        return false;
+    }
+
+    std::map<KeyIndex<S128KeyType>, Key128> new_s128_keys;
+    for (u64 i = 0; i < num_s128_keys; ++i) {
+        KeyIndex<S128KeyType> index{};
+        Key128 key{};
+        if (!ReadObject(data, position, index) || !ReadObject(data, position, key)) {
+            return false;
+        }
+        new_s128_keys.emplace_hint(new_s128_keys.end(), index, key);
+    }
+
+    u64 num_s256_keys{};
+    if (!ReadObject(data, position, num_s256_keys)) {
+        return false;
+    }
+
+    std::map<KeyIndex<S256KeyType>, Key256> new_s256_keys;
+    for (u64 i = 0; i < num_s256_keys; ++i) {
+        KeyIndex<S256KeyType> index{};
+        Key256 key{};
+        if (!ReadObject(data, position, index) || !ReadObject(data, position, key)) {
+            return false;
+        }
+        new_s256_keys.emplace_hint(new_s256_keys.end(), index, key);
+    }
+
+    auto new_encrypted_keyblobs = encrypted_keyblobs;
+    auto new_keyblobs = keyblobs;
+    auto new_eticket_extended_kek = eticket_extended_kek;
+    if (!ReadObject(data, position, new_encrypted_keyblobs) ||
+        !ReadObject(data, position, new_keyblobs) ||
+        !ReadObject(data, position, new_eticket_extended_kek) || position != data.size()) {
+        return false;
+    }
+
+    std::lock_guard lock{key_mutex};
+    s128_keys = std::move(new_s128_keys);
+    s256_keys = std::move(new_s256_keys);
+    encrypted_keyblobs = new_encrypted_keyblobs;
+    keyblobs = new_keyblobs;
+    eticket_extended_kek = new_eticket_extended_kek;
+    return true;
+}
+
+void KeyManager::WriteKeyCache(const std::string& path, u64 input_hash) const {
+    std::vector<u8> data;
+    {
+        std::lock_guard lock{key_mutex};
+        AppendObject(data, KEY_CACHE_MAGIC);
+        AppendObject(data, KEY_CACHE_VERSION);
+        AppendObject(data, input_hash);
+        AppendObject(data, static_cast<u64>(s128_keys.size()));
+        for (const auto& [index, key] : s128_keys) {
+            AppendObject(data, index);
+            AppendObject(data, key);
+        }
+        AppendObject(data, static_cast<u64>(s256_keys.size()));
+        for (const auto& [index, key] : s256_keys) {
+            AppendObject(data, index);
+            AppendObject(data, key);
+        }
+        AppendObject(data, encrypted_keyblobs);
+        AppendObject(data, keyblobs);
+        AppendObject(data, eticket_extended_kek);
+    }
+
+    Common::FS::CreateFullPath(path);
+    Common::FS::IOFile file{path, "wb"};
+    if (!file.IsOpen() || file.WriteBytes(data.data(), data.size()) != data.size()) {
+        LOG_WARNING(Crypto, "Failed to write the key cache to {}", path);
+    }
 }
 
 static bool ValidCryptoRevisionString(std::string_view base, size_t begin, size_t length) {
@@ -600,6 +755,7 @@ void KeyManager::LoadFromFile(const std::string& filename, bool is_title_keys) {
         return;
     }
 
+    std::lock_guard lock{key_mutex};
     std::string line;
     while (std::getline(file, line)) {
         std::vector<std::string> out;
@@ -723,28 +879,35 @@ bool KeyManager::BaseDeriveNecessary() const {
 }
 
 bool KeyManager::HasKey(S128KeyType id, u64 field1, u64 field2) const {
+    std::lock_guard lock{key_mutex};
     return s128_keys.find({id, field1, field2}) != s128_keys.end();
 }
 
 bool KeyManager::HasKey(S256KeyType id, u64 field1, u64 field2) const {
+    std::lock_guard lock{key_mutex};
     return s256_keys.find({id, field1, field2}) != s256_keys.end();
 }
 
 Key128 KeyManager::GetKey(S128KeyType id, u64 field1, u64 field2) const {
-    if (!HasKey(id, field1, field2)) {
+    std::lock_guard lock{key_mutex};
+    const auto iter = s128_keys.find({id, field1, field2});
+    if (iter == s128_keys.end()) {
         return {};
     }
-    return s128_keys.at({id, field1, field2});
+    return iter->second;
 }
 
 Key256 KeyManager::GetKey(S256KeyType id, u64 field1, u64 field2) const {
-    if (!HasKey(id, field1, field2)) {
+    std::lock_guard lock{key_mutex};
+    const auto iter = s256_keys.find({id, field1, field2});
+    if (iter == s256_keys.end()) {
         return {};
     }
-    return s256_keys.at({id, field1, field2});
+    return iter->second;
 }
 
 Key256 KeyManager::GetBISKey(u8 partition_id) const {
+    std::lock_guard lock{key_mutex};
     Key256 out{};
 
     for (const auto& bis_type : {BISKeyType::Crypto, BISKeyType::Tweak}) {
@@ -784,11 +947,12 @@ void KeyManager::WriteKeyToFile(KeyCategory category, std::string_view keyname,
             "# If you are experiencing issues involving keys, it may help to delete this file\n");
     }
 
+    // The caller keeps the key in memory itself, so the file does not need to be parsed again.
     file.WriteString(fmt::format("\n{} = {}", keyname, Common::HexToString(key)));
-    AttemptLoadKeyFile(yuzu_keys_dir, yuzu_keys_dir, filename, category == KeyCategory::Title);
 }
 
 void KeyManager::SetKey(S128KeyType id, Key128 key, u64 field1, u64 field2) {
+    std::lock_guard lock{key_mutex};
     if (s128_keys.find({id, field1, field2}) != s128_keys.end() || key == Key128{}) {
         return;
     }
@@ -842,6 +1006,7 @@ void KeyManager::SetKey(S128KeyType id, Key128 key, u64 field1, u64 field2) {
 }
 
 void KeyManager::SetKey(S256KeyType id, Key256 key, u64 field1, u64 field2) {
+    std::lock_guard lock{key_mutex};
     if (s256_keys.find({id, field1, field2}) != s256_keys.end() || key == Key256{}) {
         return;
     }
@@ -1107,7 +1272,8 @@ void KeyManager::PopulateTickets() {
         return;
     }
 
-    if (!common_tickets.empty() && !personal_tickets.empty()) {
+    std::lock_guard lock{key_mutex};
+    if (tickets_populated) {
         return;
     }
 
@@ -1118,6 +1284,11 @@ void KeyManager::PopulateTickets() {
                                        "/system/save/80000000000000e2",
                                    "rb+");
 
+    // Look again on the next request if the system save data is not there yet.
+    if (!save1.IsOpen() && !save2.IsOpen()) {
+        return;
+    }
+
     const auto blob2 = GetTicketblob(save2);
     auto res = GetTicketblob(save1);
     const auto idx = res.size();
@@ -1142,9 +1313,12 @@ void KeyManager::PopulateTickets() {
 
         SetKey(S128KeyType::Titlekey, key, rights_id[1], rights_id[0]);
     }
+
+    tickets_populated = true;
 }
 
 void KeyManager::SynthesizeTickets() {
+    std::lock_guard lock{key_mutex};
     for (const auto& key : s128_keys) {
         if (key.first.type != S128KeyType::Titlekey) {
             continue;
@@ -1286,6 +1460,7 @@ bool KeyManager::AddTicketCommon(Ticket raw) {
     const auto& [rid, key] = *pair;
     u128 rights_id;
     std::memcpy(rights_id.data(), rid.data(), rid.size());
+    std::lock_guard lock{key_mutex};
     common_tickets[rights_id] = raw;
     SetKey(S128KeyType::Titlekey, key, rights_id[1], rights_id[0]);
     return true;
@@ -1305,6 +1480,7 @@ bool KeyManager::AddTicketPersonalized(Ticket raw) {
     const auto& [rid, key] = *pair;
     u128 rights_id;
     std::memcpy(rights_id.data(), rid.data(), rid.size());
+    std::lock_guard lock{key_mutex};
     common_tickets[rights_id] = raw;
     SetKey(S128KeyType::Titlekey, key, rights_id[1], rights_id[0]);
     return true;
@@ -6,6 +6,7 @@
 
 #include <array>
 #include <map>
+#include <mutex>
 #include <optional>
 #include <string>
 
@@ -271,12 +272,17 @@ public:
 private:
     KeyManager();
 
+    // Guards the key maps, which may be read and extended while files are parsed on several
+    // threads. Recursive since the accessors call one another.
+    mutable std::recursive_mutex key_mutex;
     std::map<KeyIndex<S128KeyType>, Key128> s128_keys;
     std::map<KeyIndex<S256KeyType>, Key256> s256_keys;
 
     // Map from rights ID to ticket
     std::map<u128, Ticket> common_tickets;
     std::map<u128, Ticket> personal_tickets;
+    // Set once the tickets in the system save data have been read.
+    bool tickets_populated = false;
 
     std::array<std::array<u8, 0xB0>, 0x20> encrypted_keyblobs{};
     std::array<std::array<u8, 0x90>, 0x20> keyblobs{};
@@ -286,6 +292,10 @@ private:
     void LoadFromFile(const std::string& filename, bool is_title_keys);
     void AttemptLoadKeyFile(const std::string& dir1, const std::string& dir2,
                             const std::string& filename, bool title);
+    // The key cache holds the keys parsed from the key files, and is only used while the key files
+    // match input_hash.
+    bool LoadKeyCache(const std::string& path, u64 input_hash);
+    void WriteKeyCache(const std::string& path, u64 input_hash) const;
     template <size_t Size>
     void WriteKeyToFile(KeyCategory category, std::string_view keyname,
                         const std::array<u8, Size>& key);
@@ -2,4 +2,181 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
-namespace Crypto {} // namespace Crypto
+#include <algorithm>
+#include <cstring>
+#include <mbedtls/sha256.h>
+#include "core/crypto/sha_util.h"
+
+#ifdef ARCHITECTURE_x86_64
+#include <immintrin.h>
+#include "common/x64/cpu_detect.h"
+#endif
+
+namespace Core::Crypto {
+
+namespace {
+
+constexpr std::array<u32, 8> INITIAL_STATE{
+    0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19,
+};
+
+void CompressBlocksGeneric(std::array<u32, 8>& state, const u8* data, std::size_t num_blocks) {
+    mbedtls_sha256_context context;
+    mbedtls_sha256_init(&context);
+    std::copy(state.begin(), state.end(), context.state);
+
+    for (; num_blocks != 0; --num_blocks, data += 0x40) {
+        mbedtls_internal_sha256_process(&context, data);
+    }
+
+    std::copy(std::begin(context.state), std::end(context.state), state.begin());
+    mbedtls_sha256_free(&context);
+}
+
+#ifdef ARCHITECTURE_x86_64
+alignas(16) constexpr std::array<u32, 64> ROUND_CONSTANTS{
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1, 0x923F82A4, 0xAB1C5ED5,
+    0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3, 0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174,
+    0xE49B69C1, 0xEFBE4786, 0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147, 0x06CA6351, 0x14292967,
+    0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13, 0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85,
+    0xA2BFE8A1, 0xA81A664B, 0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A, 0x5B9CCA4F, 0x682E6FF3,
+    0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208, 0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
+
+#ifndef _MSC_VER
+__attribute__((target("sha,sse4.1")))
+#endif
+void CompressBlocksSHANI(std::array<u32, 8>& state, const u8* data, std::size_t num_blocks) {
+    // Converts each big-endian message word to host order.
+    const __m128i byte_swap_mask = _mm_set_epi64x(0x0C0D0E0F08090A0BULL, 0x0405060700010203ULL);
+
+    // The SHA instructions operate on the state split into ABEF and CDGH.
+    const __m128i abcd =
+        _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0])), 0xB1);
+    const __m128i efgh =
+        _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4])), 0x1B);
+    __m128i abef = _mm_alignr_epi8(abcd, efgh, 8);
+    __m128i cdgh = _mm_blend_epi16(efgh, abcd, 0xF0);
+
+    for (; num_blocks != 0; --num_blocks, data += 0x40) {
+        const __m128i abef_save = abef;
+        const __m128i cdgh_save = cdgh;
+
+        // Each iteration performs four rounds, keeping the last four message schedule vectors.
+        __m128i w[4];
+        for (std::size_t i = 0; i < 16; ++i) {
+            __m128i schedule;
+            if (i < 4) {
+                schedule = _mm_shuffle_epi8(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i * 0x10)),
+                    byte_swap_mask);
+            } else {
+                schedule = _mm_sha256msg1_epu32(w[(i - 4) % 4], w[(i - 3) % 4]);
+                schedule =
+                    _mm_add_epi32(schedule, _mm_alignr_epi8(w[(i - 1) % 4], w[(i - 2) % 4], 4));
+                schedule = _mm_sha256msg2_epu32(schedule, w[(i - 1) % 4]);
+            }
+            w[i % 4] = schedule;
+
+            __m128i message = _mm_add_epi32(
+                schedule,
+                _mm_load_si128(reinterpret_cast<const __m128i*>(&ROUND_CONSTANTS[i * 4])));
+            cdgh = _mm_sha256rnds2_epu32(cdgh, abef, message);
+            message = _mm_shuffle_epi32(message, 0x0E);
+            abef = _mm_sha256rnds2_epu32(abef, cdgh, message);
+        }
+
+        abef = _mm_add_epi32(abef, abef_save);
+        cdgh = _mm_add_epi32(cdgh, cdgh_save);
+    }
+
+    const __m128i feba = _mm_shuffle_epi32(abef, 0x1B);
+    const __m128i dchg = _mm_shuffle_epi32(cdgh, 0xB1);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), _mm_blend_epi16(feba, dchg, 0xF0));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), _mm_alignr_epi8(dchg, feba, 8));
+}
+#endif
+
+using CompressBlocksFunction = void (*)(std::array<u32, 8>&, const u8*, std::size_t);
+
+CompressBlocksFunction SelectCompressBlocks() {
+#ifdef ARCHITECTURE_x86_64
+    const auto& caps = Common::GetCPUCaps();
+    if (caps.sha && caps.sse4_1) {
+        return &CompressBlocksSHANI;
+    }
+#endif
+    return &CompressBlocksGeneric;
+}
+
+void CompressBlocks(std::array<u32, 8>& state, const u8* data, std::size_t num_blocks) {
+    static const CompressBlocksFunction compress_blocks = SelectCompressBlocks();
+    compress_blocks(state, data, num_blocks);
+}
+
+} // Anonymous namespace
+
+SHA256Hasher::SHA256Hasher() : state{INITIAL_STATE} {}
+
+void SHA256Hasher::Update(const u8* data, std::size_t size) {
+    total_size += size;
+
+    if (buffer_size != 0) {
+        const auto to_copy = std::min(size, BLOCK_SIZE - buffer_size);
+        std::memcpy(buffer.data() + buffer_size, data, to_copy);
+        buffer_size += to_copy;
+        data += to_copy;
+        size -= to_copy;
+
+        if (buffer_size != BLOCK_SIZE) {
+            return;
+        }
+        CompressBlocks(state, buffer.data(), 1);
+        buffer_size = 0;
+    }
+
+    const auto num_blocks = size / BLOCK_SIZE;
+    if (num_blocks != 0) {
+        CompressBlocks(state, data, num_blocks);
+        data += num_blocks * BLOCK_SIZE;
+        size -= num_blocks * BLOCK_SIZE;
+    }
+
+    std::memcpy(buffer.data(), data, size);
+    buffer_size = size;
+}
+
+SHA256Hash SHA256Hasher::Finish() {
+    const u64 bit_length = total_size * 8;
+
+    buffer[buffer_size++] = 0x80;
+    if (buffer_size > BLOCK_SIZE - sizeof(u64)) {
+        std::fill(buffer.begin() + buffer_size, buffer.end(), u8{0});
+        CompressBlocks(state, buffer.data(), 1);
+        buffer_size = 0;
+    }
+    std::fill(buffer.begin() + buffer_size, buffer.end() - sizeof(u64), u8{0});
+    for (std::size_t i = 0; i < sizeof(u64); ++i) {
+        buffer[BLOCK_SIZE - 1 - i] = static_cast<u8>(bit_length >> (i * 8));
+    }
+    CompressBlocks(state, buffer.data(), 1);
+
+    SHA256Hash hash;
+    for (std::size_t i = 0; i < state.size(); ++i) {
+        hash[i * 4] = static_cast<u8>(state[i] >> 24);
+        hash[i * 4 + 1] = static_cast<u8>(state[i] >> 16);
+        hash[i * 4 + 2] = static_cast<u8>(state[i] >> 8);
+        hash[i * 4 + 3] = static_cast<u8>(state[i]);
+    }
+    return hash;
+}
+
+SHA256Hash CalculateSHA256(const u8* data, std::size_t size) {
+    SHA256Hasher hasher;
+    hasher.Update(data, size);
+    return hasher.Finish();
+}
+
+} // namespace Core::Crypto
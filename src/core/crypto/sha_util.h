@@ -4,17 +4,42 @@
 
 #pragma once
 
-#include "common/assert.h"
-#include "core/file_sys/vfs.h"
-#include "key_manager.h"
-#include "mbedtls/cipher.h"
+#include <array>
+#include <cstddef>
+#include <vector>
+#include "common/common_types.h"
+#include "core/crypto/key_manager.h"
 
-namespace Crypto {
-typedef std::array<u8, 0x20> SHA256Hash;
+namespace Core::Crypto {
 
-inline SHA256Hash operator"" _HASH(const char* data, size_t len) {
-    if (len != 0x40)
-        return {};
+// Incremental SHA-256. Whole blocks are compressed with the x86 SHA extensions when the host CPU
+// has them and with a portable implementation otherwise.
+class SHA256Hasher {
+public:
+    SHA256Hasher();
+
+    void Update(const u8* data, std::size_t size);
+
+    void Update(const std::vector<u8>& data) {
+        Update(data.data(), data.size());
+    }
+
+    // Pads the message and returns its hash. The hasher must not be updated afterwards.
+    SHA256Hash Finish();
+
+private:
+    static constexpr std::size_t BLOCK_SIZE = 0x40;
+
+    std::array<u32, 8> state;
+    std::array<u8, BLOCK_SIZE> buffer{};
+    std::size_t buffer_size = 0;
+    u64 total_size = 0;
+};
+
+SHA256Hash CalculateSHA256(const u8* data, std::size_t size);
+
+inline SHA256Hash CalculateSHA256(const std::vector<u8>& data) {
+    return CalculateSHA256(data.data(), data.size());
 }
 
-} // namespace Crypto
+} // namespace Core::Crypto
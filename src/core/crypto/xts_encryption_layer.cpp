@@ -12,47 +12,46 @@ namespace Core::Crypto {
 constexpr u64 XTS_SECTOR_SIZE = 0x4000;
 
 XTSEncryptionLayer::XTSEncryptionLayer(FileSys::VirtualFile base_, Key256 key_)
-    : EncryptionLayer(std::move(base_)), cipher(key_, Mode::XTS) {}
+    : EncryptionLayer(std::move(base_)), cipher(key_, Mode::XTS), sector_buffer(XTS_SECTOR_SIZE) {}
 
 std::size_t XTSEncryptionLayer::Read(u8* data, std::size_t length, std::size_t offset) const {
-    if (length == 0)
-        return 0;
-
-    const auto sector_offset = offset & 0x3FFF;
-    if (sector_offset == 0) {
-        if (length % XTS_SECTOR_SIZE == 0) {
-            std::vector<u8> raw = base->ReadBytes(length, offset);
-            cipher.XTSTranscode(raw.data(), raw.size(), data, offset / XTS_SECTOR_SIZE,
-                                XTS_SECTOR_SIZE, Op::Decrypt);
-            return raw.size();
+    std::size_t total_read = 0;
+
+    while (length != 0) {
+        const auto sector_offset = offset & (XTS_SECTOR_SIZE - 1);
+        if (sector_offset == 0 && length >= XTS_SECTOR_SIZE) {
+            // Whole sectors are decrypted in place in the caller's buffer.
+            const auto raw_read = base->Read(data, length - length % XTS_SECTOR_SIZE, offset);
+            const auto read = raw_read - raw_read % XTS_SECTOR_SIZE;
+            cipher.XTSTranscode(data, read, data, offset / XTS_SECTOR_SIZE, XTS_SECTOR_SIZE,
+                                Op::Decrypt);
+            data += read;
+            length -= read;
+            offset += read;
+            total_read += read;
+            if (read != 0) {
+                continue;
+            }
         }
-        if (length > XTS_SECTOR_SIZE) {
-            const auto rem = length % XTS_SECTOR_SIZE;
-            const auto read = length - rem;
-            return Read(data, read, offset) + Read(data + read, rem, offset + read);
+
+        // Partial sector (unaligned offset, short tail or end of file), bounce through the buffer
+        const auto sector_start = offset - sector_offset;
+        const auto raw_read = base->Read(sector_buffer.data(), XTS_SECTOR_SIZE, sector_start);
+        if (raw_read == 0) {
+            break;
         }
-        std::vector<u8> buffer = base->ReadBytes(XTS_SECTOR_SIZE, offset);
-        if (buffer.size() < XTS_SECTOR_SIZE)
-            buffer.resize(XTS_SECTOR_SIZE);
-        cipher.XTSTranscode(buffer.data(), buffer.size(), buffer.data(), offset / XTS_SECTOR_SIZE,
-                            XTS_SECTOR_SIZE, Op::Decrypt);
-        std::memcpy(data, buffer.data(), std::min(buffer.size(), length));
-        return std::min(buffer.size(), length);
+        std::fill(sector_buffer.begin() + raw_read, sector_buffer.end(), u8{0});
+        cipher.XTSTranscode(sector_buffer.data(), XTS_SECTOR_SIZE, sector_buffer.data(),
+                            sector_start / XTS_SECTOR_SIZE, XTS_SECTOR_SIZE, Op::Decrypt);
+
+        const auto read = std::min<std::size_t>(length, XTS_SECTOR_SIZE - sector_offset);
+        std::memcpy(data, sector_buffer.data() + sector_offset, read);
+        data += read;
+        length -= read;
+        offset += read;
+        total_read += read;
     }
 
-    // offset does not fall on block boundary (0x4000)
-    std::vector<u8> block = base->ReadBytes(0x4000, offset - sector_offset);
-    if (block.size() < XTS_SECTOR_SIZE)
-        block.resize(XTS_SECTOR_SIZE);
-    cipher.XTSTranscode(block.data(), block.size(), block.data(),
-                        (offset - sector_offset) / XTS_SECTOR_SIZE, XTS_SECTOR_SIZE, Op::Decrypt);
-    const std::size_t read = XTS_SECTOR_SIZE - sector_offset;
-
-    if (length + sector_offset < XTS_SECTOR_SIZE) {
-        std::memcpy(data, block.data() + sector_offset, std::min<u64>(length, read));
-        return std::min<u64>(length, read);
-    }
-    std::memcpy(data, block.data() + sector_offset, read);
-    return read + Read(data + read, length - read, offset + read);
+    return total_read;
 }
 } // namespace Core::Crypto
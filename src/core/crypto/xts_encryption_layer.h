@@ -4,6 +4,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "core/crypto/aes_util.h"
 #include "core/crypto/encryption_layer.h"
 #include "core/crypto/key_manager.h"
@@ -20,6 +22,8 @@ public:
 private:
     // Must be mutable as operations modify cipher contexts.
     mutable AESCipher<Key256> cipher;
+    // Bounce buffer for reads that do not cover whole sectors, allocated once per layer.
+    mutable std::vector<u8> sector_buffer;
 };
 
 } // namespace Core::Crypto
@@ -0,0 +1,114 @@
+// Copyright 2020 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/file_util.h"
+#include "core/crypto/key_manager.h"
+#include "core/file_sys/card_image.h"
+#include "core/file_sys/container_cache.h"
+#include "core/file_sys/nca_metadata.h"
+#include "core/file_sys/submission_package.h"
+#include "core/file_sys/vfs_real.h"
+#include "core/loader/loader.h"
+
+namespace FileSys {
+
+namespace {
+// Enough to cover a game list scan handing the same files between its passes, while bounding the
+// number of host files kept open.
+constexpr std::size_t CACHE_CAPACITY = 32;
+
+struct CacheKey {
+    std::string path;
+    s64 last_write_time;
+    u64 size;
+    std::size_t program_index;
+
+    bool operator==(const CacheKey&) const = default;
+};
+
+std::optional<CacheKey> MakeCacheKey(const VirtualFile& file, std::size_t program_index) {
+    // Only host files can be told apart by their path and modification time.
+    if (dynamic_cast<const RealVfsFile*>(file.get()) == nullptr) {
+        return std::nullopt;
+    }
+
+    auto path = file->GetFullPath();
+    const auto last_write_time = Common::FS::GetLastWriteTime(path);
+    if (last_write_time == 0) {
+        return std::nullopt;
+    }
+
+    return CacheKey{std::move(path), last_write_time, file->GetSize(), program_index};
+}
+
+// Containers whose program could not be read, for instance for lack of keys, are parsed again
+// next time, as the cause may be fixed without touching the file.
+bool IsFullyParsed(const NSP& nsp) {
+    return nsp.GetStatus() == Loader::ResultStatus::Success &&
+           nsp.GetProgramStatus(nsp.GetProgramTitleID()) == Loader::ResultStatus::Success;
+}
+
+bool IsFullyParsed(const XCI& xci) {
+    return xci.GetStatus() == Loader::ResultStatus::Success &&
+           xci.GetProgramNCAStatus() == Loader::ResultStatus::Success;
+}
+
+template <typename Container>
+class ContainerCache {
+public:
+    std::shared_ptr<Container> Open(VirtualFile file, std::size_t program_index) {
+        auto key = MakeCacheKey(file, program_index);
+        if (key) {
+            std::lock_guard lock{mutex};
+            const auto iter =
+                std::find_if(entries.begin(), entries.end(),
+                             [&key](const auto& entry) { return entry.first == *key; });
+            if (iter != entries.end()) {
+                // Keep the entries ordered from most to least recently used.
+                std::rotate(entries.begin(), iter, iter + 1);
+                return entries.front().second;
+            }
+        }
+
+        // Parse outside of the lock, so files can be parsed concurrently.
+        auto container = std::make_shared<Container>(std::move(file), program_index);
+        if (!key || !IsFullyParsed(*container)) {
+            return container;
+        }
+
+        std::lock_guard lock{mutex};
+        std::erase_if(entries, [&key](const auto& entry) {
+            return entry.first.path == key->path && entry.first.program_index == key->program_index;
+        });
+        entries.emplace(entries.begin(), std::move(*key), container);
+        if (entries.size() > CACHE_CAPACITY) {
+            entries.pop_back();
+        }
+        return container;
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<std::pair<CacheKey, std::shared_ptr<Container>>> entries;
+};
+} // Anonymous namespace
+
+std::shared_ptr<NSP> OpenNSP(VirtualFile file, std::size_t program_index) {
+    static ContainerCache<NSP> cache;
+    return cache.Open(std::move(file), program_index);
+}
+
+std::shared_ptr<XCI> OpenXCI(VirtualFile file, std::size_t program_index) {
+    static ContainerCache<XCI> cache;
+    return cache.Open(std::move(file), program_index);
+}
+
+} // namespace FileSys
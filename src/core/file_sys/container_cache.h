@@ -0,0 +1,23 @@
+// Copyright 2020 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include "core/file_sys/vfs_types.h"
+
+namespace FileSys {
+
+class NSP;
+class XCI;
+
+// Parsing an NSP or XCI reads and decrypts the headers of every NCA in it, and the same file is
+// typically parsed several times in a row: once to identify it, once by its loader and again by
+// the game list. These return a shared parse of the container, reusing one of the most recently
+// parsed host files if its path, size and modification time are unchanged.
+std::shared_ptr<NSP> OpenNSP(VirtualFile file, std::size_t program_index = 0);
+std::shared_ptr<XCI> OpenXCI(VirtualFile file, std::size_t program_index = 0);
+
+} // namespace FileSys
@@ -7,13 +7,16 @@
 #include <optional>
 #include <utility>
 
+#include "common/cityhash.h"
 #include "common/logging/log.h"
 #include "core/crypto/aes_util.h"
 #include "core/crypto/ctr_encryption_layer.h"
 #include "core/crypto/key_manager.h"
+#include "core/crypto/sha_util.h"
 #include "core/file_sys/content_archive.h"
 #include "core/file_sys/nca_patch.h"
 #include "core/file_sys/partition_filesystem.h"
+#include "core/file_sys/vfs_cached.h"
 #include "core/file_sys/vfs_offset.h"
 #include "core/loader/loader.h"
 
@@ -45,7 +48,8 @@ struct IVFCHeader {
     u32_le magic_number;
     INSERT_UNION_PADDING_BYTES(8);
     std::array<IVFCLevel, 6> levels;
-    INSERT_UNION_PADDING_BYTES(64);
+    INSERT_UNION_PADDING_BYTES(32);
+    std::array<u8, 0x20> master_hash;
 };
 static_assert(sizeof(IVFCHeader) == 0xE0, "IVFCHeader has incorrect size.");
 
@@ -236,6 +240,7 @@ bool NCA::ReadSections(const std::vector<NCASectionHeader>& sections, u64 bktr_b
         }
     }
 
+    section_headers = sections;
     return true;
 }
 
@@ -497,14 +502,31 @@ VirtualFile NCA::Decrypt(const NCASectionHeader& s_header, VirtualFile in, u64 s
                 }
             }
 
-            auto out = std::make_shared<Core::Crypto::CTREncryptionLayer>(std::move(in), *key,
-                                                                          starting_offset);
             Core::Crypto::CTREncryptionLayer::IVData iv{};
             for (std::size_t i = 0; i < 8; ++i) {
                 iv[i] = s_header.raw.section_ctr[8 - i - 1];
             }
+
+            // The decrypted blocks are shared with any other NCA object reading the same range of
+            // the same host file with the same key and counter.
+            std::optional<u64> source_id;
+            if (const auto storage_id = GetHostStorageId(in)) {
+                std::array<u8, sizeof(u64) * 2 + sizeof(Core::Crypto::Key128) + sizeof(iv)>
+                    source{};
+                std::memcpy(source.data(), &*storage_id, sizeof(u64));
+                std::memcpy(source.data() + sizeof(u64), &starting_offset, sizeof(u64));
+                std::memcpy(source.data() + sizeof(u64) * 2, key->data(), key->size());
+                std::memcpy(source.data() + sizeof(u64) * 2 + key->size(), iv.data(), iv.size());
+                source_id = Common::CityHash64(reinterpret_cast<const char*>(source.data()),
+                                               source.size());
+            }
+
+            auto out = std::make_shared<Core::Crypto::CTREncryptionLayer>(std::move(in), *key,
+                                                                          starting_offset);
             out->SetIV(iv);
-            return std::static_pointer_cast<VfsFile>(out);
+            // Game data re-reads the same small RomFS metadata and asset blocks constantly, so
+            // keep recently decrypted blocks around rather than decrypting them again.
+            return std::make_shared<CachedVfsFile>(std::move(out), source_id);
         }
     case NCASectionCryptoType::XTS:
         // TODO(DarkLordZach): Find a test case for XTS-encrypted NCAs
@@ -583,4 +605,141 @@ VirtualDir NCA::GetLogoPartition() const {
     return logo;
 }
 
+namespace {
+// Checks section data against tables of per-block SHA-256 hashes, reporting progress as it goes.
+class HashTableVerifier {
+public:
+    HashTableVerifier(std::size_t total_, const NCA::VerifyProgressCallback& callback_)
+        : total{total_}, callback{callback_} {}
+
+    bool IsCancelled() const {
+        return cancelled;
+    }
+
+    // IVFC hashes a short final block as if it was padded with zeroes to the block size, while
+    // the hierarchical SHA-256 table of PFS0 sections hashes it as it is.
+    bool Verify(const VfsFile& data, const std::vector<u8>& hashes, std::size_t data_offset,
+                std::size_t data_size, std::size_t block_size, bool pad_last_block) {
+        if (block_size == 0) {
+            return false;
+        }
+        const auto num_blocks = (data_size + block_size - 1) / block_size;
+        if (hashes.size() < num_blocks * sizeof(Core::Crypto::SHA256Hash)) {
+            return false;
+        }
+
+        constexpr std::size_t READ_SIZE = 0x100000;
+        const auto chunk_size = std::max(block_size, READ_SIZE / block_size * block_size);
+        std::vector<u8> buffer(std::min(chunk_size, num_blocks * block_size));
+
+        std::size_t block_index = 0;
+        for (std::size_t offset = 0; offset < data_size; offset += chunk_size) {
+            const auto length = std::min(chunk_size, data_size - offset);
+            if (data.Read(buffer.data(), length, data_offset + offset) != length) {
+                return false;
+            }
+            std::fill(buffer.begin() + length, buffer.end(), u8{0});
+
+            for (std::size_t block = 0; block < length; block += block_size) {
+                const auto hash_size = pad_last_block ? block_size
+                                                      : std::min(block_size, length - block);
+                const auto hash = Core::Crypto::CalculateSHA256(buffer.data() + block, hash_size);
+                if (std::memcmp(hash.data(), hashes.data() + block_index * hash.size(),
+                                hash.size()) != 0) {
+                    return false;
+                }
+                ++block_index;
+            }
+
+            processed += length;
+            if (callback && !callback(processed, total)) {
+                cancelled = true;
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+private:
+    std::size_t processed = 0;
+    std::size_t total;
+    bool cancelled = false;
+    const NCA::VerifyProgressCallback& callback;
+};
+} // Anonymous namespace
+
+bool NCA::VerifyIntegrity(const VerifyProgressCallback& callback) {
+    std::size_t total = 0;
+    for (const auto& section : section_headers) {
+        if (section.raw.header.crypto_type == NCASectionCryptoType::BKTR) {
+            continue;
+        }
+        if (section.raw.header.filesystem_type == NCASectionFilesystemType::PFS0) {
+            total += section.pfs0.pfs0_size;
+        } else if (section.raw.header.filesystem_type == NCASectionFilesystemType::ROMFS) {
+            for (const auto& level : section.romfs.ivfc.levels) {
+                total += level.size;
+            }
+        }
+    }
+
+    HashTableVerifier verifier{total, callback};
+    for (std::size_t i = 0; i < section_headers.size(); ++i) {
+        const auto& section = section_headers[i];
+        if (section.raw.header.crypto_type == NCASectionCryptoType::BKTR) {
+            continue;
+        }
+
+        // Decrypting the whole section again must not change the status of the NCA.
+        const auto& entry = header.section_tables[i];
+        const u64 offset = MEDIA_OFFSET_MULTIPLIER * entry.media_offset;
+        const u64 size = MEDIA_OFFSET_MULTIPLIER * (entry.media_end_offset - entry.media_offset);
+        const auto previous_status = status;
+        const auto data =
+            Decrypt(section, std::make_shared<OffsetVfsFile>(file, size, offset), offset);
+        status = previous_status;
+
+        if (data == nullptr) {
+            LOG_ERROR(Loader, "Section {} of NCA {} could not be decrypted for verification.", i,
+                      GetName());
+            return false;
+        }
+
+        bool verified = true;
+        if (section.raw.header.filesystem_type == NCASectionFilesystemType::PFS0) {
+            const auto& pfs0 = section.pfs0;
+            const auto hashes = data->ReadBytes(pfs0.hash_table_size, pfs0.hash_table_offset);
+            verified = hashes.size() == pfs0.hash_table_size &&
+                       Core::Crypto::CalculateSHA256(hashes) == pfs0.hash &&
+                       verifier.Verify(*data, hashes, pfs0.pfs0_header_offset, pfs0.pfs0_size,
+                                       pfs0.size, false);
+        } else if (section.raw.header.filesystem_type == NCASectionFilesystemType::ROMFS) {
+            // The master hash covers the first level, and each level holds the hashes of the next.
+            const auto& levels = section.romfs.ivfc.levels;
+            std::vector<u8> hashes(section.romfs.ivfc.master_hash.begin(),
+                                   section.romfs.ivfc.master_hash.end());
+            for (std::size_t level = 0; level < levels.size() && verified; ++level) {
+                const auto& ivfc_level = levels[level];
+                verified = ivfc_level.block_size < 32 &&
+                           verifier.Verify(*data, hashes, ivfc_level.offset, ivfc_level.size,
+                                           std::size_t{1} << ivfc_level.block_size, true);
+                if (verified && level + 1 < levels.size()) {
+                    hashes = data->ReadBytes(ivfc_level.size, ivfc_level.offset);
+                }
+            }
+        }
+
+        if (verifier.IsCancelled()) {
+            return false;
+        }
+        if (!verified) {
+            LOG_ERROR(Loader, "Section {} of NCA {} does not match its hashes.", i, GetName());
+            return false;
+        }
+    }
+
+    return true;
+}
+
 } // namespace FileSys
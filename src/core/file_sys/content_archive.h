@@ -5,6 +5,7 @@
 #pragma once
 
 #include <array>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
@@ -125,6 +126,14 @@ public:
 
     VirtualDir GetLogoPartition() const;
 
+    // Called with the number of bytes hashed so far and the total. Returning false cancels.
+    using VerifyProgressCallback = std::function<bool(std::size_t, std::size_t)>;
+
+    // Checks the contents of every section against its hash tree, the hierarchical SHA-256 table
+    // for PFS0 and the IVFC levels for RomFS. BKTR sections are skipped, as they can only be
+    // checked after patching. Returns false on a mismatch or if cancelled by the callback.
+    bool VerifyIntegrity(const VerifyProgressCallback& callback);
+
 private:
     bool CheckSupportedNCA(const NCAHeader& header);
     bool HandlePotentialHeaderDecryption();
@@ -158,6 +167,9 @@ private:
     bool encrypted = false;
     bool is_update = false;
 
+    // Headers of the sections, kept for VerifyIntegrity.
+    std::vector<NCASectionHeader> section_headers;
+
     Core::Crypto::KeyManager& keys;
 };
 
@@ -96,6 +96,7 @@ struct RomFSBuildFileContext {
     std::shared_ptr<RomFSBuildDirectoryContext> parent;
     std::shared_ptr<RomFSBuildFileContext> sibling;
     VirtualFile source;
+    VirtualFile original_source;
 };
 
 static u32 romfs_calc_path_hash(u32 parent, std::string_view path, u32 start,
@@ -170,6 +171,7 @@ void RomFSBuildContext::VisitDirectory(VirtualDir root_romfs, VirtualDir ext,
             ASSERT(child->path_len < FS_MAX_PATH);
 
             child->source = root_romfs->GetFileRelative(child->path);
+            child->original_source = child->source;
 
             if (ext != nullptr) {
                 const auto ips = ext->GetFileRelative(child->path + ".ips");
@@ -385,4 +387,14 @@ std::multimap<u64, VirtualFile> RomFSBuildContext::Build() {
     return out;
 }
 
+std::vector<RomFSBuildContext::FileSource> RomFSBuildContext::GetFileSources() const {
+    std::vector<FileSource> out;
+    out.reserve(files.size());
+    for (const auto& [path, file] : files) {
+        out.push_back({path, file->offset + ROMFS_FILEPARTITION_OFS, file->size, file->source,
+                       file->original_source});
+    }
+    return out;
+}
+
 } // namespace FileSys
@@ -27,6 +27,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 #include "common/common_types.h"
 #include "core/file_sys/vfs.h"
 
@@ -42,9 +43,23 @@ public:
     explicit RomFSBuildContext(VirtualDir base, VirtualDir ext = nullptr);
     ~RomFSBuildContext();
 
+    // Describes where the data of one file in the built RomFS comes from.
+    struct FileSource {
+        std::string path;
+        // Offset of the file data within the built RomFS.
+        u64 offset;
+        u64 size;
+        // The file placed in the RomFS, and the file it was IPS patched from, if any.
+        VirtualFile source;
+        VirtualFile original_source;
+    };
+
     // This finalizes the context.
     std::multimap<u64, VirtualFile> Build();
 
+    // Only valid after Build.
+    std::vector<FileSource> GetFileSources() const;
+
 private:
     VirtualDir base;
     VirtualDir ext;
@@ -0,0 +1,397 @@
+// Copyright 2020 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "common/cityhash.h"
+#include "common/common_funcs.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "core/crypto/key_manager.h"
+#include "core/file_sys/card_image.h"
+#include "core/file_sys/container_cache.h"
+#include "core/file_sys/content_archive.h"
+#include "core/file_sys/control_metadata.h"
+#include "core/file_sys/game_file_index.h"
+#include "core/file_sys/mode.h"
+#include "core/file_sys/registered_cache.h"
+#include "core/file_sys/submission_package.h"
+#include "core/loader/loader.h"
+
+namespace FileSys {
+
+namespace {
+constexpr u32 INDEX_MAGIC = Common::MakeMagic('G', 'F', 'I', 'X');
+constexpr u32 INDEX_VERSION = 2;
+
+class IndexWriter {
+public:
+    template <typename T>
+    void Write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "Data type must be trivially copyable.");
+        const auto* bytes = reinterpret_cast<const u8*>(&value);
+        data.insert(data.end(), bytes, bytes + sizeof(T));
+    }
+
+    template <typename Container>
+    void WriteSequence(const Container& sequence) {
+        Write(static_cast<u64>(sequence.size()));
+        const auto* bytes = reinterpret_cast<const u8*>(sequence.data());
+        data.insert(data.end(), bytes, bytes + sequence.size() * sizeof(sequence[0]));
+    }
+
+    const std::vector<u8>& GetData() const {
+        return data;
+    }
+
+private:
+    std::vector<u8> data;
+};
+
+class IndexReader {
+public:
+    explicit IndexReader(std::vector<u8> data_) : data(std::move(data_)) {}
+
+    template <typename T>
+    bool Read(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>, "Data type must be trivially copyable.");
+        if (sizeof(T) > data.size() - position) {
+            return false;
+        }
+        std::memcpy(&value, data.data() + position, sizeof(T));
+        position += sizeof(T);
+        return true;
+    }
+
+    template <typename Container>
+    bool ReadSequence(Container& sequence) {
+        u64 size{};
+        if (!Read(size) || size > (data.size() - position) / sizeof(sequence[0])) {
+            return false;
+        }
+        sequence.resize(size);
+        std::memcpy(sequence.data(), data.data() + position, size * sizeof(sequence[0]));
+        position += size * sizeof(sequence[0]);
+        return true;
+    }
+
+private:
+    std::vector<u8> data;
+    std::size_t position = 0;
+};
+
+std::vector<GameFileEntry::Content> GetContents(const VirtualFile& file,
+                                                Loader::FileType file_type, u64 program_id) {
+    std::vector<GameFileEntry::Content> out;
+    if (file_type == Loader::FileType::NCA) {
+        out.push_back({program_id, TitleType::Application,
+                       GetCRTypeFromNCAType(NCA{file}.GetType())});
+        return out;
+    }
+
+    if (file_type != Loader::FileType::XCI && file_type != Loader::FileType::NSP) {
+        return out;
+    }
+
+    const auto nsp = file_type == Loader::FileType::NSP
+                         ? OpenNSP(file)
+                         : OpenXCI(file)->GetSecurePartitionNSP();
+    for (const auto& [title_id, title_ncas] : nsp->GetNCAs()) {
+        for (const auto& [types, nca] : title_ncas) {
+            out.push_back({title_id, types.first, types.second});
+        }
+    }
+    return out;
+}
+
+// Stands in for an NCA inside an NSP or XCI, and only parses the container once it is used.
+class ContainedNCAFile final : public VfsFile {
+public:
+    ContainedNCAFile(VirtualFilesystem vfs_, std::string path_, Loader::FileType file_type_,
+                     GameFileEntry::Content content_)
+        : vfs(std::move(vfs_)), path(std::move(path_)), file_type(file_type_),
+          content(content_) {}
+
+    std::string GetName() const override {
+        return Resolve() == nullptr ? std::string{} : Resolve()->GetName();
+    }
+
+    std::size_t GetSize() const override {
+        return Resolve() == nullptr ? 0 : Resolve()->GetSize();
+    }
+
+    bool Resize(std::size_t new_size) override {
+        return false;
+    }
+
+    VirtualDir GetContainingDirectory() const override {
+        return Resolve() == nullptr ? nullptr : Resolve()->GetContainingDirectory();
+    }
+
+    bool IsWritable() const override {
+        return false;
+    }
+
+    bool IsReadable() const override {
+        return true;
+    }
+
+    std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override {
+        return Resolve() == nullptr ? 0 : Resolve()->Read(data, length, offset);
+    }
+
+    std::span<const u8> GetSpan(std::size_t offset, std::size_t length) const override {
+        return Resolve() == nullptr ? std::span<const u8>{} : Resolve()->GetSpan(offset, length);
+    }
+
+    std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override {
+        return 0;
+    }
+
+    bool Rename(std::string_view name) override {
+        return false;
+    }
+
+private:
+    const VirtualFile& Resolve() const {
+        std::call_once(resolved, [this] {
+            const auto container = vfs->OpenFile(path, Mode::Read);
+            if (container == nullptr) {
+                return;
+            }
+            const auto nsp = file_type == Loader::FileType::NSP
+                                 ? OpenNSP(container)
+                                 : OpenXCI(container)->GetSecurePartitionNSP();
+            const auto ncas = nsp->GetNCAs();
+            const auto title_iter = ncas.find(content.title_id);
+            if (title_iter == ncas.end()) {
+                return;
+            }
+            const auto& title_ncas = title_iter->second;
+            const auto nca_iter = title_ncas.find({content.title_type, content.record_type});
+            if (nca_iter != title_ncas.end()) {
+                file = nca_iter->second->GetBaseFile();
+            }
+        });
+        return file;
+    }
+
+    VirtualFilesystem vfs;
+    std::string path;
+    Loader::FileType file_type;
+    GameFileEntry::Content content;
+
+    mutable std::once_flag resolved;
+    mutable VirtualFile file;
+};
+} // Anonymous namespace
+
+GameFileIndex::GameFileIndex(std::string index_path_) : index_path(std::move(index_path_)) {
+    if (index_path.empty()) {
+        return;
+    }
+
+    std::vector<u8> data;
+    {
+        Common::FS::IOFile file{index_path, "rb"};
+        if (!file.IsOpen()) {
+            return;
+        }
+        data.resize(file.GetSize());
+        if (file.ReadBytes(data.data(), data.size()) != data.size()) {
+            return;
+        }
+    }
+
+    IndexReader reader{std::move(data)};
+    u32 magic{};
+    u32 version{};
+    u64 num_files{};
+    if (!reader.Read(magic) || magic != INDEX_MAGIC || !reader.Read(version) ||
+        version != INDEX_VERSION || !reader.Read(num_files)) {
+        return;
+    }
+
+    std::map<std::string, IndexedFile> loaded;
+    for (u64 i = 0; i < num_files; ++i) {
+        std::string path;
+        IndexedFile indexed{};
+        auto& entry = indexed.entry;
+        u8 has_program_id{};
+        u8 has_control_data{};
+        if (!reader.ReadSequence(path) || !reader.Read(indexed.size) ||
+            !reader.Read(indexed.last_write_time) || !reader.Read(entry.file_type) ||
+            !reader.Read(has_program_id) || !reader.Read(entry.program_id) ||
+            !reader.ReadSequence(entry.contents) || !reader.Read(has_control_data) ||
+            !reader.ReadSequence(entry.name) || !reader.ReadSequence(entry.version) ||
+            !reader.ReadSequence(entry.icon) || !reader.Read(indexed.control_stamp)) {
+            LOG_WARNING(Loader, "Game file index at {} is corrupted, ignoring it", index_path);
+            return;
+        }
+        entry.has_program_id = has_program_id != 0;
+        entry.has_control_data = has_control_data != 0;
+        loaded.insert_or_assign(std::move(path), std::move(indexed));
+    }
+
+    files = std::move(loaded);
+}
+
+GameFileIndex::~GameFileIndex() = default;
+
+GameFileEntry GameFileIndex::GetEntry(Core::System& system, const VirtualFilesystem& vfs,
+                                      const std::string& path, bool with_control_data) {
+    const auto size = Common::FS::GetSize(path);
+    const auto last_write_time = Common::FS::GetLastWriteTime(path);
+
+    std::optional<GameFileEntry> indexed_entry;
+    {
+        std::lock_guard lock{mutex};
+        const auto iter = files.find(path);
+        if (iter != files.end() && iter->second.size == size &&
+            iter->second.last_write_time == last_write_time) {
+            iter->second.used = true;
+            const auto& indexed = iter->second;
+            const bool is_game = indexed.entry.file_type != Loader::FileType::Error &&
+                                 indexed.entry.file_type != Loader::FileType::Unknown;
+            if (!with_control_data || !is_game ||
+                (indexed.entry.has_control_data &&
+                 indexed.control_stamp == GetControlStamp(indexed.entry.program_id))) {
+                return iter->second.entry;
+            }
+            indexed_entry = iter->second.entry;
+        }
+    }
+
+    GameFileEntry entry{};
+    const auto file = vfs->OpenFile(path, Mode::Read);
+    const auto loader = file == nullptr ? nullptr : Loader::GetLoader(system, file);
+    entry.file_type = loader == nullptr ? Loader::FileType::Error : loader->GetFileType();
+    const bool is_game =
+        entry.file_type != Loader::FileType::Error && entry.file_type != Loader::FileType::Unknown;
+
+    if (is_game) {
+        if (indexed_entry) {
+            entry = std::move(*indexed_entry);
+        } else {
+            entry.has_program_id =
+                loader->ReadProgramId(entry.program_id) == Loader::ResultStatus::Success;
+            if (entry.has_program_id) {
+                entry.contents = GetContents(file, entry.file_type, entry.program_id);
+            }
+        }
+
+        if (with_control_data) {
+            entry.icon.clear();
+            [[maybe_unused]] const auto icon_result = loader->ReadIcon(entry.icon);
+
+            entry.name = " ";
+            const auto title_result = loader->ReadTitle(entry.name);
+
+            entry.version.clear();
+            NACP nacp;
+            if (loader->ReadControlData(nacp) == Loader::ResultStatus::Success) {
+                entry.version = nacp.GetVersionString();
+            }
+            entry.has_control_data = title_result == Loader::ResultStatus::Success;
+        }
+    }
+
+    // Parsing mostly fails because of missing keys, so keep trying until it succeeds rather than
+    // remembering the failure until the file changes.
+    std::lock_guard lock{mutex};
+    if (!is_game || !entry.has_program_id) {
+        files.erase(path);
+        return entry;
+    }
+    const auto control_stamp = entry.has_control_data ? GetControlStamp(entry.program_id) : 0;
+    files.insert_or_assign(path,
+                           IndexedFile{size, last_write_time, entry, control_stamp, true});
+    return entry;
+}
+
+VirtualFile GameFileIndex::OpenContent(const VirtualFilesystem& vfs, const std::string& path,
+                                       const GameFileEntry& entry,
+                                       const GameFileEntry::Content& content) {
+    if (entry.file_type == Loader::FileType::NCA) {
+        return vfs->OpenFile(path, Mode::Read);
+    }
+    return std::make_shared<ContainedNCAFile>(vfs, path, entry.file_type, content);
+}
+
+void GameFileIndex::Save() const {
+    if (index_path.empty()) {
+        return;
+    }
+
+    IndexWriter writer;
+    {
+        std::lock_guard lock{mutex};
+        const auto num_used = std::count_if(files.begin(), files.end(),
+                                            [](const auto& file) { return file.second.used; });
+
+        writer.Write(INDEX_MAGIC);
+        writer.Write(INDEX_VERSION);
+        writer.Write(static_cast<u64>(num_used));
+        for (const auto& [path, indexed] : files) {
+            if (!indexed.used) {
+                continue;
+            }
+            const auto& entry = indexed.entry;
+            writer.WriteSequence(path);
+            writer.Write(indexed.size);
+            writer.Write(indexed.last_write_time);
+            writer.Write(entry.file_type);
+            writer.Write(static_cast<u8>(entry.has_program_id));
+            writer.Write(entry.program_id);
+            writer.WriteSequence(entry.contents);
+            writer.Write(static_cast<u8>(entry.has_control_data));
+            writer.WriteSequence(entry.name);
+            writer.WriteSequence(entry.version);
+            writer.WriteSequence(entry.icon);
+            writer.Write(indexed.control_stamp);
+        }
+    }
+
+    const auto& data = writer.GetData();
+    Common::FS::CreateFullPath(index_path);
+    Common::FS::IOFile file{index_path, "wb"};
+    if (!file.IsOpen() || file.WriteBytes(data.data(), data.size()) != data.size()) {
+        LOG_WARNING(Loader, "Failed to write game file index to {}", index_path);
+    }
+}
+
+u64 GameFileIndex::GetControlStamp(u64 program_id) const {
+    // The control data of a program is read with its update applied, so it is stale once the
+    // files providing the update change.
+    // Only files seen in the current scan count, which have all been looked up by the time any
+    // control data is read.
+    const auto update_id = GetUpdateTitleID(program_id);
+    u64 stamp = 0;
+    for (const auto& [path, indexed] : files) {
+        if (!indexed.used) {
+            continue;
+        }
+        const auto& contents = indexed.entry.contents;
+        const bool has_update =
+            std::any_of(contents.begin(), contents.end(),
+                        [update_id](const auto& content) { return content.title_id == update_id; });
+        if (!has_update) {
+            continue;
+        }
+        stamp = Common::CityHash64WithSeed(path.data(), path.size(), stamp);
+        stamp = Common::CityHash64WithSeed(reinterpret_cast<const char*>(&indexed.size),
+                                           sizeof(indexed.size), stamp);
+        stamp = Common::CityHash64WithSeed(reinterpret_cast<const char*>(&indexed.last_write_time),
+                                           sizeof(indexed.last_write_time), stamp);
+    }
+    return stamp;
+}
+
+} // namespace FileSys
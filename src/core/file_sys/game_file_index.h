@@ -0,0 +1,90 @@
+// Copyright 2020 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "common/common_types.h"
+#include "core/file_sys/nca_metadata.h"
+#include "core/file_sys/vfs_types.h"
+
+namespace Core {
+class System;
+}
+
+namespace Loader {
+enum class FileType;
+}
+
+namespace FileSys {
+
+// What a game list needs to know about one game file on the host.
+struct GameFileEntry {
+    // A title provided by the file, such as the game itself, an update or DLC.
+    struct Content {
+        u64 title_id;
+        TitleType title_type;
+        ContentRecordType record_type;
+    };
+
+    Loader::FileType file_type{};
+    bool has_program_id = false;
+    u64 program_id = 0;
+    std::vector<Content> contents;
+
+    // Read from the control data, with updates applied.
+    bool has_control_data = false;
+    std::string name;
+    std::string version;
+    std::vector<u8> icon;
+};
+
+// An on-disk index of the game files found on the host, so that rescanning a game directory only
+// needs to look at the size and modification time of each file. Files are only opened and parsed
+// again when they are new or have changed, or when they could not be identified as a game with a
+// program ID the last time, such as when the keys to decrypt them were missing.
+class GameFileIndex {
+public:
+    // Loads the index saved at index_path, if any. An empty index_path keeps the index in memory.
+    explicit GameFileIndex(std::string index_path);
+    ~GameFileIndex();
+
+    // Returns the entry for the game file at path. With with_control_data set, the name, version
+    // and icon are filled in as well, and read again when the updates indexed for the program have
+    // changed since. Only the files looked up since the index was loaded count as indexed, so
+    // control data should only be asked for once every game file has been looked up. Thread-safe.
+    GameFileEntry GetEntry(Core::System& system, const VirtualFilesystem& vfs,
+                           const std::string& path, bool with_control_data);
+
+    // Returns the file of one of the contents of the game file at path. NSP and XCI files are only
+    // parsed once the returned file is first used.
+    static VirtualFile OpenContent(const VirtualFilesystem& vfs, const std::string& path,
+                                   const GameFileEntry& entry,
+                                   const GameFileEntry::Content& content);
+
+    // Writes the entries looked up since the index was loaded to disk, dropping all others.
+    void Save() const;
+
+private:
+    struct IndexedFile {
+        u64 size;
+        s64 last_write_time;
+        GameFileEntry entry;
+        // Identifies the update files the control data was read with.
+        u64 control_stamp;
+        bool used;
+    };
+
+    u64 GetControlStamp(u64 program_id) const;
+
+    std::string index_path;
+
+    mutable std::mutex mutex;
+    std::map<std::string, IndexedFile> files;
+};
+
+} // namespace FileSys
@@ -0,0 +1,57 @@
+// Copyright 2020 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace FileSys {
+
+// Finds which of a list of adjacent intervals contains an offset, given the sorted start offsets
+// of the intervals. The start offsets are kept in one flat array and the interval found by the
+// previous lookup is remembered, so the sequential lookups made while streaming through a file,
+// which land in the same or the following interval, skip the binary search entirely.
+class IntervalIndex {
+public:
+    explicit IntervalIndex(std::vector<u64> starts_) : starts(std::move(starts_)) {}
+
+    /// Returns the index of the last interval starting at or before offset, which must not
+    /// precede the first interval.
+    std::size_t Find(u64 offset) const {
+        const auto hint = last_hit.load(std::memory_order_relaxed);
+        if (Contains(hint, offset)) {
+            return hint;
+        }
+        if (Contains(hint + 1, offset)) {
+            last_hit.store(hint + 1, std::memory_order_relaxed);
+            return hint + 1;
+        }
+
+        const auto iter = std::upper_bound(starts.begin(), starts.end(), offset);
+        const auto index = static_cast<std::size_t>(std::distance(starts.begin(), iter)) - 1;
+        last_hit.store(index, std::memory_order_relaxed);
+        return index;
+    }
+
+    std::size_t Size() const {
+        return starts.size();
+    }
+
+private:
+    bool Contains(std::size_t index, u64 offset) const {
+        return index < starts.size() && starts[index] <= offset &&
+               (index + 1 == starts.size() || offset < starts[index + 1]);
+    }
+
+    std::vector<u64> starts;
+    mutable std::atomic<std::size_t> last_hit{};
+};
+
+} // namespace FileSys
@@ -7,8 +7,15 @@
 #include <map>
 #include <sstream>
 #include <string>
+#include <type_traits>
 #include <utility>
 
+#include <fmt/format.h>
+
+#include "common/cityhash.h"
+#include "common/common_funcs.h"
+#include "common/common_paths.h"
+#include "common/file_util.h"
 #include "common/hex_util.h"
 #include "common/logging/log.h"
 #include "common/swap.h"
@@ -37,6 +44,9 @@ constexpr std::array<std::pair<const char*, const char*>, 11> ESCAPE_CHARACTER_M
     {"\\\?", "\?"},
 }};
 
+constexpr u32 COMPILED_PATCH_MAGIC = Common::MakeMagic('I', 'P', 'S', 'C');
+constexpr u32 COMPILED_PATCH_VERSION = 1;
+
 static IPSFileType IdentifyMagic(const std::vector<u8>& magic) {
     if (magic.size() != 5) {
         return IPSFileType::Error;
@@ -65,16 +75,33 @@ static bool IsEOF(IPSFileType type, const std::vector<u8>& data) {
     return type == IPSFileType::IPS32 && std::equal(data.begin(), data.end(), eeof.begin());
 }
 
-VirtualFile PatchIPS(const VirtualFile& in, const VirtualFile& ips) {
-    if (in == nullptr || ips == nullptr)
-        return nullptr;
+void IPSPatchSet::Apply(std::span<u8> buffer, std::size_t buffer_offset) const {
+    const u64 buffer_end = buffer_offset + buffer.size();
+    for (const auto& record : records) {
+        const u64 begin = std::max<u64>(record.offset, buffer_offset);
+        const u64 end = std::min<u64>(u64{record.offset} + record.size, buffer_end);
+        if (begin >= end) {
+            continue;
+        }
+
+        u8* const destination = buffer.data() + (begin - buffer_offset);
+        if (record.data.size() == 1) {
+            std::memset(destination, record.data[0], end - begin);
+        } else {
+            std::memcpy(destination, record.data.data() + (begin - record.offset), end - begin);
+        }
+    }
+}
+
+std::optional<IPSPatchSet> CompileIPS(const VirtualFile& ips) {
+    if (ips == nullptr)
+        return std::nullopt;
 
     const auto type = IdentifyMagic(ips->ReadBytes(0x5));
     if (type == IPSFileType::Error)
-        return nullptr;
-
-    auto in_data = in->ReadAllBytes();
+        return std::nullopt;
 
+    IPSPatchSet out;
     std::vector<u8> temp(type == IPSFileType::IPS ? 3 : 4);
     u64 offset = 5; // After header
     while (ips->Read(temp.data(), temp.size(), offset) == temp.size()) {
@@ -91,38 +118,164 @@ VirtualFile PatchIPS(const VirtualFile& in, const VirtualFile& ips) {
 
         u16 data_size{};
         if (ips->ReadObject(&data_size, offset) != sizeof(u16))
-            return nullptr;
+            return std::nullopt;
         data_size = Common::swap16(data_size);
         offset += sizeof(u16);
 
         if (data_size == 0) { // RLE
             u16 rle_size{};
             if (ips->ReadObject(&rle_size, offset) != sizeof(u16))
-                return nullptr;
+                return std::nullopt;
             rle_size = Common::swap16(rle_size);
             offset += sizeof(u16);
 
             const auto data = ips->ReadByte(offset++);
             if (!data)
-                return nullptr;
+                return std::nullopt;
 
-            if (real_offset + rle_size > in_data.size())
-                rle_size = static_cast<u16>(in_data.size() - real_offset);
-            std::memset(in_data.data() + real_offset, *data, rle_size);
+            out.records.push_back({real_offset, rle_size, {*data}});
         } else { // Standard Patch
-            auto read = data_size;
-            if (real_offset + read > in_data.size())
-                read = static_cast<u16>(in_data.size() - real_offset);
-            if (ips->Read(in_data.data() + real_offset, read, offset) != data_size)
-                return nullptr;
+            std::vector<u8> data(data_size);
+            if (ips->Read(data.data(), data_size, offset) != data_size)
+                return std::nullopt;
             offset += data_size;
+
+            out.records.push_back({real_offset, data_size, std::move(data)});
         }
     }
 
     if (!IsEOF(type, temp)) {
-        return nullptr;
+        return std::nullopt;
     }
 
+    return out;
+}
+
+template <typename T>
+static void AppendObject(std::vector<u8>& out, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>, "Data type must be trivially copyable.");
+    const auto* bytes = reinterpret_cast<const u8*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+static bool ReadObject(const std::vector<u8>& in, std::size_t& position, T& value) {
+    static_assert(std::is_trivially_copyable_v<T>, "Data type must be trivially copyable.");
+    if (sizeof(T) > in.size() - position) {
+        return false;
+    }
+    std::memcpy(&value, in.data() + position, sizeof(T));
+    position += sizeof(T);
+    return true;
+}
+
+static std::vector<u8> SerializePatchSet(const IPSPatchSet& patch_set, u64 source_hash) {
+    std::vector<u8> out;
+    AppendObject(out, COMPILED_PATCH_MAGIC);
+    AppendObject(out, COMPILED_PATCH_VERSION);
+    AppendObject(out, source_hash);
+    AppendObject(out, patch_set.build_id);
+    AppendObject(out, static_cast<u64>(patch_set.records.size()));
+    for (const auto& record : patch_set.records) {
+        AppendObject(out, record.offset);
+        AppendObject(out, record.size);
+        AppendObject(out, static_cast<u32>(record.data.size()));
+        out.insert(out.end(), record.data.begin(), record.data.end());
+    }
+    return out;
+}
+
+static std::optional<IPSPatchSet> DeserializePatchSet(const std::vector<u8>& in,
+                                                      u64 source_hash) {
+    std::size_t position = 0;
+    u32 magic{};
+    u32 version{};
+    u64 hash{};
+    IPSPatchSet out;
+    u64 num_records{};
+    if (!ReadObject(in, position, magic) || magic != COMPILED_PATCH_MAGIC ||
+        !ReadObject(in, position, version) || version != COMPILED_PATCH_VERSION ||
+        !ReadObject(in, position, hash) || hash != source_hash ||
+        !ReadObject(in, position, out.build_id) || !ReadObject(in, position, num_records)) {
+        return std::nullopt;
+    }
+
+    for (u64 i = 0; i < num_records; ++i) {
+        IPSPatchSet::Record record{};
+        u32 data_size{};
+        if (!ReadObject(in, position, record.offset) || !ReadObject(in, position, record.size) ||
+            !ReadObject(in, position, data_size) || data_size > in.size() - position) {
+            return std::nullopt;
+        }
+        // Apply() copies record.size bytes of data, or repeats a single byte.
+        if (data_size != record.size && (data_size != 1 || record.size == 0)) {
+            return std::nullopt;
+        }
+        record.data.assign(in.begin() + position, in.begin() + position + data_size);
+        position += data_size;
+        out.records.push_back(std::move(record));
+    }
+
+    return out;
+}
+
+std::optional<IPSPatchSet> LoadPatchSet(const VirtualFile& patch_file, u64 title_id,
+                                        std::string_view mod_name) {
+    if (patch_file == nullptr) {
+        return std::nullopt;
+    }
+
+    const auto source = patch_file->ReadAllBytes();
+    const auto source_hash =
+        Common::CityHash64(reinterpret_cast<const char*>(source.data()), source.size());
+    const auto compiled_path =
+        fmt::format("{}patches" DIR_SEP "{:016X}" DIR_SEP "{}" DIR_SEP "{}",
+                    Common::FS::GetUserPath(Common::FS::UserPath::CacheDir), title_id, mod_name,
+                    patch_file->GetName());
+
+    {
+        Common::FS::IOFile compiled{compiled_path, "rb"};
+        std::vector<u8> data(compiled.IsOpen() ? compiled.GetSize() : 0);
+        if (!data.empty() && compiled.ReadBytes(data.data(), data.size()) == data.size()) {
+            if (auto patch_set = DeserializePatchSet(data, source_hash)) {
+                return patch_set;
+            }
+        }
+    }
+
+    std::optional<IPSPatchSet> patch_set;
+    if (patch_file->GetExtension() == "pchtxt") {
+        const IPSwitchCompiler compiler{patch_file};
+        if (compiler.IsValid()) {
+            patch_set = compiler.Compile();
+        }
+    } else {
+        patch_set = CompileIPS(patch_file);
+    }
+
+    if (patch_set) {
+        const auto data = SerializePatchSet(*patch_set, source_hash);
+        Common::FS::CreateFullPath(compiled_path);
+        Common::FS::IOFile compiled{compiled_path, "wb"};
+        if (!compiled.IsOpen() || compiled.WriteBytes(data.data(), data.size()) != data.size()) {
+            LOG_WARNING(Loader, "Failed to cache the compiled patch {}", patch_file->GetName());
+        }
+    }
+
+    return patch_set;
+}
+
+VirtualFile PatchIPS(const VirtualFile& in, const VirtualFile& ips) {
+    if (in == nullptr)
+        return nullptr;
+
+    const auto patch_set = CompileIPS(ips);
+    if (!patch_set)
+        return nullptr;
+
+    auto in_data = in->ReadAllBytes();
+    patch_set->Apply(in_data);
+
     return std::make_shared<VectorVfsFile>(std::move(in_data), in->GetName(),
                                            in->GetContainingDirectory());
 }
@@ -311,27 +464,29 @@ void IPSwitchCompiler::Parse() {
     valid = true;
 }
 
-VirtualFile IPSwitchCompiler::Apply(const VirtualFile& in) const {
-    if (in == nullptr || !valid)
-        return nullptr;
-
-    auto in_data = in->ReadAllBytes();
+IPSPatchSet IPSwitchCompiler::Compile() const {
+    IPSPatchSet out;
+    out.build_id = nso_build_id;
 
     for (const auto& patch : patches) {
         if (!patch.enabled)
             continue;
 
-        for (const auto& record : patch.records) {
-            if (record.first >= in_data.size())
-                continue;
-            auto replace_size = record.second.size();
-            if (record.first + replace_size > in_data.size())
-                replace_size = in_data.size() - record.first;
-            for (std::size_t i = 0; i < replace_size; ++i)
-                in_data[i + record.first] = record.second[i];
+        for (const auto& [offset, data] : patch.records) {
+            out.records.push_back({offset, static_cast<u32>(data.size()), data});
         }
     }
 
+    return out;
+}
+
+VirtualFile IPSwitchCompiler::Apply(const VirtualFile& in) const {
+    if (in == nullptr || !valid)
+        return nullptr;
+
+    auto in_data = in->ReadAllBytes();
+    Compile().Apply(in_data);
+
     return std::make_shared<VectorVfsFile>(std::move(in_data), in->GetName(),
                                            in->GetContainingDirectory());
 }
@@ -6,6 +6,9 @@
 
 #include <array>
 #include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
 #include <vector>
 
 #include "common/common_types.h"
@@ -13,6 +16,34 @@
 
 namespace FileSys {
 
+// The writes made by an IPS or IPSwitch patch, compiled so that they can be applied without
+// parsing the patch again.
+struct IPSPatchSet {
+    struct Record {
+        u32 offset;
+        // Number of bytes written. A record holding a single byte of data repeats it this often.
+        u32 size;
+        std::vector<u8> data;
+    };
+
+    // Applies the records in order to buffer, which holds the bytes of the patched file starting
+    // at buffer_offset. Anything written outside of the buffer is dropped.
+    void Apply(std::span<u8> buffer, std::size_t buffer_offset = 0) const;
+
+    // Only set for IPSwitch patches, which name the build ID of the NSO they apply to.
+    std::array<u8, 0x20> build_id{};
+    std::vector<Record> records;
+};
+
+// Returns std::nullopt if ips is not a valid IPS or IPS32 patch.
+std::optional<IPSPatchSet> CompileIPS(const VirtualFile& ips);
+
+// Compiles an IPS or IPSwitch patch file from the mod mod_name of the title title_id. The result
+// is cached in the cache directory, and reused for as long as the patch file does not change.
+// Returns std::nullopt if the patch is not valid.
+std::optional<IPSPatchSet> LoadPatchSet(const VirtualFile& patch_file, u64 title_id,
+                                        std::string_view mod_name);
+
 VirtualFile PatchIPS(const VirtualFile& in, const VirtualFile& ips);
 
 class IPSwitchCompiler {
@@ -22,6 +53,8 @@ public:
 
     std::array<u8, 0x20> GetBuildID() const;
     bool IsValid() const;
+    // Collects the records of the enabled patches. Must only be called on a valid patch.
+    IPSPatchSet Compile() const;
     VirtualFile Apply(const VirtualFile& in) const;
 
 private:
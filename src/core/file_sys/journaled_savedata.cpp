@@ -0,0 +1,992 @@
+// Copyright 2020 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <utility>
+
+#include "common/common_funcs.h"
+#include "common/div_ceil.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "core/file_sys/journaled_savedata.h"
+
+namespace FileSys {
+namespace {
+constexpr u32 JOURNAL_MAGIC = Common::MakeMagic('S', 'J', 'N', 'L');
+constexpr u32 JOURNAL_VERSION = 1;
+constexpr u32 COMMIT_MAGIC = Common::MakeMagic('S', 'J', 'C', 'M');
+
+// Granularity at which file contents are compared and journaled.
+constexpr std::size_t BLOCK_SIZE = 0x4000;
+
+// Once the journal holds more commits or data than this, it is compacted to about half of it.
+constexpr std::size_t MAX_SNAPSHOTS = 32;
+constexpr std::size_t MAX_JOURNAL_SIZE = 0x4000000;
+
+struct JournalHeader {
+    u32_le magic;
+    u32_le version;
+    INSERT_PADDING_WORDS(2);
+};
+static_assert(sizeof(JournalHeader) == 0x10, "JournalHeader has incorrect size.");
+
+// Followed by size bytes of undo records.
+struct CommitHeader {
+    u32_le magic;
+    u32_le num_undos;
+    u64_le commit_id;
+    s64_le timestamp;
+    u64_le size;
+};
+static_assert(sizeof(CommitHeader) == 0x20, "CommitHeader has incorrect size.");
+
+// Followed by the path, the new path and data_size bytes of data.
+struct UndoHeader {
+    u8 type;
+    INSERT_PADDING_BYTES(1);
+    u16_le path_size;
+    u16_le new_path_size;
+    INSERT_PADDING_BYTES(2);
+    u64_le offset;
+    u64_le size;
+    u64_le data_size;
+};
+static_assert(sizeof(UndoHeader) == 0x20, "UndoHeader has incorrect size.");
+
+enum class UndoType : u8 {
+    // Writes data back at offset.
+    Write,
+    // Resizes the file back to size.
+    Resize,
+    // Deletes a file that was created.
+    DeleteFile,
+    // Recreates a file that was deleted, with data as its contents.
+    CreateFile,
+    // Deletes a directory that was created.
+    DeleteDirectory,
+    // Recreates a directory that was deleted.
+    CreateDirectory,
+    // Renames new_path back to path.
+    Rename,
+};
+
+std::string JoinPath(std::string_view dir, std::string_view name) {
+    std::string out{dir};
+    while (!name.empty()) {
+        const auto end = name.find_first_of("/\\");
+        const auto component = name.substr(0, end);
+        if (!component.empty()) {
+            if (!out.empty()) {
+                out += '/';
+            }
+            out += component;
+        }
+        if (end == std::string_view::npos) {
+            break;
+        }
+        name.remove_prefix(end + 1);
+    }
+    return out;
+}
+
+std::string GetParentPath(const std::string& path) {
+    const auto pos = path.rfind('/');
+    return pos == std::string::npos ? std::string{} : path.substr(0, pos);
+}
+
+std::string GetFilename(const std::string& path) {
+    const auto pos = path.rfind('/');
+    return pos == std::string::npos ? path : path.substr(pos + 1);
+}
+
+s64 GetTimestamp() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+class JournaledSaveFile : public VfsFile {
+public:
+    JournaledSaveFile(std::shared_ptr<SaveDataJournal> journal_, std::string path_)
+        : journal{std::move(journal_)}, path{std::move(path_)} {}
+
+    std::string GetName() const override {
+        return GetFilename(path);
+    }
+
+    std::size_t GetSize() const override {
+        return journal->GetFileSize(path);
+    }
+
+    bool Resize(std::size_t new_size) override {
+        return journal->ResizeFile(path, new_size);
+    }
+
+    VirtualDir GetContainingDirectory() const override {
+        return std::make_shared<JournaledSaveDirectory>(journal, GetParentPath(path));
+    }
+
+    bool IsWritable() const override {
+        return true;
+    }
+
+    bool IsReadable() const override {
+        return true;
+    }
+
+    std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override {
+        return journal->ReadFile(path, data, length, offset);
+    }
+
+    std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override {
+        return journal->WriteFile(path, data, length, offset);
+    }
+
+    bool Rename(std::string_view name) override {
+        if (!journal->Rename(path, name)) {
+            return false;
+        }
+        path = JoinPath(GetParentPath(path), name);
+        return true;
+    }
+
+private:
+    std::shared_ptr<SaveDataJournal> journal;
+    std::string path;
+};
+
+} // Anonymous namespace
+
+struct SaveDataJournal::Undo {
+    UndoType type{};
+    std::string path{};
+    std::string new_path{};
+    u64 offset = 0;
+    u64 size = 0;
+    std::vector<u8> data{};
+};
+
+SaveDataJournal::SaveDataJournal(VirtualDir root_, VirtualFile journal_)
+    : root{std::move(root_)}, journal{std::move(journal_)} {
+    LoadJournal();
+}
+
+SaveDataJournal::~SaveDataJournal() {
+    Commit();
+}
+
+void SaveDataJournal::LoadJournal() {
+    if (journal == nullptr) {
+        return;
+    }
+
+    JournalHeader header{};
+    if (journal->ReadObject(&header) != sizeof(JournalHeader) || header.magic != JOURNAL_MAGIC ||
+        header.version != JOURNAL_VERSION) {
+        header = {};
+        header.magic = JOURNAL_MAGIC;
+        header.version = JOURNAL_VERSION;
+        journal->Resize(0);
+        journal->WriteObject(header);
+        return;
+    }
+
+    const auto journal_size = journal->GetSize();
+    std::size_t offset = sizeof(JournalHeader);
+    while (offset < journal_size) {
+        CommitHeader commit{};
+        if (journal->ReadObject(&commit, offset) != sizeof(CommitHeader) ||
+            commit.magic != COMMIT_MAGIC ||
+            journal_size - offset - sizeof(CommitHeader) < commit.size) {
+            break;
+        }
+
+        const auto size = sizeof(CommitHeader) + static_cast<std::size_t>(commit.size);
+        commits.push_back({commit.commit_id, commit.timestamp, offset, size});
+        next_commit_id = commit.commit_id + 1;
+        offset += size;
+    }
+
+    // A commit that was cut short never made it to the save data.
+    if (offset < journal_size) {
+        LOG_WARNING(Service_FS, "Dropping incomplete commit at the end of the save data journal");
+        journal->Resize(offset);
+    }
+}
+
+VirtualDir SaveDataJournal::GetBaseDirectory(const std::string& path) const {
+    return path.empty() ? root : root->GetDirectoryRelative(path);
+}
+
+VirtualFile SaveDataJournal::GetBaseFile(const std::string& path) const {
+    const auto iter = base_files.find(path);
+    if (iter != base_files.end()) {
+        return iter->second;
+    }
+
+    auto file = root->GetFileRelative(path);
+    if (file != nullptr) {
+        base_files.emplace(path, file);
+    }
+    return file;
+}
+
+SaveDataJournal::PendingFile* SaveDataJournal::GetPendingFile(const std::string& path) {
+    const auto iter = pending_files.find(path);
+    if (iter != pending_files.end()) {
+        return &iter->second;
+    }
+
+    const auto base = GetBaseFile(path);
+    if (base == nullptr) {
+        return nullptr;
+    }
+
+    const auto size = base->GetSize();
+    return &pending_files.emplace(path, PendingFile{size, size, {}}).first->second;
+}
+
+std::vector<u8> SaveDataJournal::ReadBlock(const PendingFile& pending, const VirtualFile& base,
+                                           std::size_t index) const {
+    std::vector<u8> block(BLOCK_SIZE);
+    const auto offset = index * BLOCK_SIZE;
+    if (base != nullptr && offset < pending.committed_size) {
+        base->Read(block.data(), std::min(BLOCK_SIZE, pending.committed_size - offset), offset);
+    }
+    return block;
+}
+
+std::size_t SaveDataJournal::GetFileSize(const std::string& path) const {
+    std::lock_guard lock{mutex};
+
+    const auto iter = pending_files.find(path);
+    if (iter != pending_files.end()) {
+        return iter->second.size;
+    }
+
+    const auto base = GetBaseFile(path);
+    return base == nullptr ? 0 : base->GetSize();
+}
+
+std::size_t SaveDataJournal::ReadFile(const std::string& path, u8* data, std::size_t length,
+                                      std::size_t offset) const {
+    std::lock_guard lock{mutex};
+
+    const auto base = GetBaseFile(path);
+    const auto iter = pending_files.find(path);
+    if (iter == pending_files.end()) {
+        return base == nullptr ? 0 : base->Read(data, length, offset);
+    }
+
+    const auto& pending = iter->second;
+    if (offset >= pending.size) {
+        return 0;
+    }
+    length = std::min(length, pending.size - offset);
+
+    std::size_t done = 0;
+    while (done < length) {
+        const auto position = offset + done;
+        const auto in_block = position % BLOCK_SIZE;
+        const auto count = std::min(BLOCK_SIZE - in_block, length - done);
+
+        const auto block = pending.blocks.find(position / BLOCK_SIZE);
+        if (block != pending.blocks.end()) {
+            std::memcpy(data + done, block->second.data() + in_block, count);
+        } else {
+            std::size_t read = 0;
+            if (base != nullptr && position < pending.committed_size) {
+                read = base->Read(data + done, std::min(count, pending.committed_size - position),
+                                  position);
+            }
+            std::memset(data + done + read, 0, count - read);
+        }
+
+        done += count;
+    }
+
+    return length;
+}
+
+std::size_t SaveDataJournal::WriteFile(const std::string& path, const u8* data,
+                                       std::size_t length, std::size_t offset) {
+    std::lock_guard lock{mutex};
+
+    auto* const pending = GetPendingFile(path);
+    if (pending == nullptr) {
+        return 0;
+    }
+
+    const auto base = GetBaseFile(path);
+    std::size_t done = 0;
+    while (done < length) {
+        const auto position = offset + done;
+        const auto index = position / BLOCK_SIZE;
+        const auto in_block = position % BLOCK_SIZE;
+        const auto count = std::min(BLOCK_SIZE - in_block, length - done);
+
+        auto block = pending->blocks.find(index);
+        if (block == pending->blocks.end()) {
+            block = pending->blocks.emplace(index, ReadBlock(*pending, base, index)).first;
+        }
+        std::memcpy(block->second.data() + in_block, data + done, count);
+
+        done += count;
+    }
+
+    pending->size = std::max(pending->size, offset + length);
+    return length;
+}
+
+bool SaveDataJournal::ResizeFile(const std::string& path, std::size_t new_size) {
+    std::lock_guard lock{mutex};
+
+    auto* const pending = GetPendingFile(path);
+    if (pending == nullptr) {
+        return false;
+    }
+
+    if (new_size < pending->size) {
+        auto& blocks = pending->blocks;
+        blocks.erase(blocks.lower_bound(Common::DivCeil(new_size, BLOCK_SIZE)), blocks.end());
+
+        // Clear the cut off end of the last block, in case the file grows again.
+        if (const auto in_block = new_size % BLOCK_SIZE; in_block != 0) {
+            const auto index = new_size / BLOCK_SIZE;
+            auto block = blocks.find(index);
+            if (block == blocks.end()) {
+                block = blocks.emplace(index, ReadBlock(*pending, GetBaseFile(path), index)).first;
+            }
+            std::fill(block->second.begin() + in_block, block->second.end(), u8{0});
+        }
+
+        pending->committed_size = std::min(pending->committed_size, new_size);
+    }
+
+    pending->size = new_size;
+    return true;
+}
+
+bool SaveDataJournal::CreateFile(const std::string& path) {
+    std::lock_guard lock{mutex};
+
+    if (GetBaseFile(path) != nullptr) {
+        return true;
+    }
+
+    const auto parent = GetBaseDirectory(GetParentPath(path));
+    if (parent == nullptr || parent->CreateFile(GetFilename(path)) == nullptr) {
+        return false;
+    }
+
+    created_files.insert(path);
+    pending_undos.push_back({UndoType::DeleteFile, path});
+    return true;
+}
+
+bool SaveDataJournal::DeleteFile(const std::string& path) {
+    std::lock_guard lock{mutex};
+
+    const auto parent = GetBaseDirectory(GetParentPath(path));
+    auto base = GetBaseFile(path);
+    if (parent == nullptr || base == nullptr) {
+        return false;
+    }
+
+    Undo undo{UndoType::CreateFile, path};
+    undo.data = base->ReadAllBytes();
+    base.reset();
+    base_files.clear();
+
+    if (!parent->DeleteFile(GetFilename(path))) {
+        return false;
+    }
+
+    pending_files.erase(path);
+    created_files.erase(path);
+    pending_undos.push_back(std::move(undo));
+    return true;
+}
+
+bool SaveDataJournal::CreateDirectory(const std::string& path) {
+    std::lock_guard lock{mutex};
+
+    // Walks the path one directory at a time, creating the missing ones.
+    std::string current;
+    std::string_view remaining = path;
+    while (!remaining.empty()) {
+        const auto end = remaining.find('/');
+        const auto next = JoinPath(current, remaining.substr(0, end));
+        if (next != current && GetBaseDirectory(next) == nullptr) {
+            const auto parent = GetBaseDirectory(current);
+            if (parent == nullptr || parent->CreateSubdirectory(GetFilename(next)) == nullptr) {
+                return false;
+            }
+            pending_undos.push_back({UndoType::DeleteDirectory, next});
+        }
+
+        current = next;
+        if (end == std::string_view::npos) {
+            break;
+        }
+        remaining.remove_prefix(end + 1);
+    }
+
+    return true;
+}
+
+void SaveDataJournal::RecordDirectoryDeletion(const std::string& path, const VirtualDir& dir,
+                                              std::vector<Undo>& undos) {
+    for (const auto& file : dir->GetFiles()) {
+        const auto file_path = JoinPath(path, file->GetName());
+        Undo undo{UndoType::CreateFile, file_path};
+        undo.data = file->ReadAllBytes();
+        undos.push_back(std::move(undo));
+    }
+
+    for (const auto& subdir : dir->GetSubdirectories()) {
+        RecordDirectoryDeletion(JoinPath(path, subdir->GetName()), subdir, undos);
+    }
+
+    undos.push_back({UndoType::CreateDirectory, path});
+}
+
+bool SaveDataJournal::DeleteDirectory(const std::string& path) {
+    std::lock_guard lock{mutex};
+
+    const auto parent = GetBaseDirectory(GetParentPath(path));
+    auto dir = GetBaseDirectory(path);
+    if (path.empty() || parent == nullptr || dir == nullptr) {
+        return false;
+    }
+
+    // Undone in reverse, so the directory is recreated before its contents.
+    std::vector<Undo> undos;
+    RecordDirectoryDeletion(path, dir, undos);
+    dir.reset();
+    base_files.clear();
+
+    if (!parent->DeleteSubdirectory(GetFilename(path))) {
+        return false;
+    }
+
+    for (auto& undo : undos) {
+        if (undo.type == UndoType::CreateFile) {
+            pending_files.erase(undo.path);
+            created_files.erase(undo.path);
+        }
+        pending_undos.push_back(std::move(undo));
+    }
+    return true;
+}
+
+void SaveDataJournal::MovePendingEntries(const std::string& path, const std::string& new_path) {
+    const auto is_below = [&path](const std::string& entry) {
+        return entry.size() >= path.size() && entry.compare(0, path.size(), path) == 0 &&
+               (entry.size() == path.size() || entry[path.size()] == '/');
+    };
+    const auto renamed = [&path, &new_path](const std::string& entry) {
+        return new_path + entry.substr(path.size());
+    };
+
+    std::vector<std::string> moved;
+    for (const auto& [entry, pending] : pending_files) {
+        if (is_below(entry)) {
+            moved.push_back(entry);
+        }
+    }
+    for (const auto& entry : moved) {
+        auto node = pending_files.extract(entry);
+        node.key() = renamed(entry);
+        pending_files.insert(std::move(node));
+    }
+
+    moved.clear();
+    for (const auto& entry : created_files) {
+        if (is_below(entry)) {
+            moved.push_back(entry);
+        }
+    }
+    for (const auto& entry : moved) {
+        created_files.erase(entry);
+        created_files.insert(renamed(entry));
+    }
+}
+
+bool SaveDataJournal::Rename(const std::string& path, std::string_view new_name) {
+    std::lock_guard lock{mutex};
+
+    const auto new_path = JoinPath(GetParentPath(path), new_name);
+    if (path.empty() || new_path == path) {
+        return !path.empty();
+    }
+
+    base_files.clear();
+    bool renamed = false;
+    if (const auto file = root->GetFileRelative(path); file != nullptr) {
+        renamed = file->Rename(GetFilename(new_path));
+    } else if (const auto dir = GetBaseDirectory(path); dir != nullptr) {
+        renamed = dir->Rename(GetFilename(new_path));
+    }
+    if (!renamed) {
+        return false;
+    }
+
+    MovePendingEntries(path, new_path);
+    pending_undos.push_back({UndoType::Rename, path, new_path});
+    return true;
+}
+
+bool SaveDataJournal::Commit() {
+    std::lock_guard lock{mutex};
+    return CommitImpl();
+}
+
+bool SaveDataJournal::CommitImpl() {
+    if (pending_files.empty() && pending_undos.empty()) {
+        return true;
+    }
+
+    struct BlockWrite {
+        VirtualFile file;
+        std::size_t offset;
+        std::vector<u8> data;
+    };
+
+    std::vector<Undo> undos = std::move(pending_undos);
+    pending_undos.clear();
+    std::vector<std::pair<VirtualFile, std::size_t>> resizes;
+    std::vector<BlockWrite> writes;
+
+    for (auto& [path, pending] : pending_files) {
+        const auto base = GetBaseFile(path);
+        if (base == nullptr) {
+            continue;
+        }
+
+        // A file created since the last commit is deleted when undone, so its old contents are
+        // not needed.
+        const bool keep_old = created_files.find(path) == created_files.end();
+        const auto base_size = base->GetSize();
+
+        if (pending.size != base_size) {
+            if (keep_old) {
+                for (auto offset = pending.size; offset < base_size; offset += BLOCK_SIZE) {
+                    Undo undo{UndoType::Write, path, {}, offset};
+                    undo.data = base->ReadBytes(std::min(BLOCK_SIZE, base_size - offset), offset);
+                    undos.push_back(std::move(undo));
+                }
+                undos.push_back({UndoType::Resize, path, {}, 0, base_size});
+            }
+            resizes.emplace_back(base, pending.size);
+        }
+
+        // The blocks cut off by a resize and not written since are cleared as well.
+        const auto cleared_end = std::min(base_size, pending.size);
+        for (auto index = Common::DivCeil(pending.committed_size, BLOCK_SIZE);
+             index * BLOCK_SIZE < cleared_end; ++index) {
+            pending.blocks.try_emplace(index, BLOCK_SIZE);
+        }
+
+        for (auto& [index, block] : pending.blocks) {
+            const auto offset = index * BLOCK_SIZE;
+            const auto length = std::min(BLOCK_SIZE, pending.size - offset);
+            const auto old_length = offset < base_size ? std::min(length, base_size - offset) : 0;
+
+            // Only the blocks that differ from the host are written.
+            auto old = base->ReadBytes(old_length, offset);
+            if (old.size() == old_length && std::equal(old.begin(), old.end(), block.begin()) &&
+                std::all_of(block.begin() + old_length, block.begin() + length,
+                            [](u8 value) { return value == 0; })) {
+                continue;
+            }
+
+            if (keep_old && old_length != 0) {
+                Undo undo{UndoType::Write, path, {}, offset};
+                undo.data = std::move(old);
+                undos.push_back(std::move(undo));
+            }
+            block.resize(length);
+            writes.push_back({base, offset, std::move(block)});
+        }
+    }
+
+    pending_files.clear();
+    created_files.clear();
+
+    if (undos.empty() && resizes.empty() && writes.empty()) {
+        return true;
+    }
+
+    // The journal is written before the save data, so that a commit interrupted halfway can
+    // still be reverted.
+    if (!AppendCommit(undos)) {
+        LOG_ERROR(Service_FS, "Failed to journal the commit, it will not be revertible");
+    }
+
+    bool success = true;
+    for (const auto& [file, size] : resizes) {
+        success &= file->Resize(size);
+    }
+    for (const auto& write : writes) {
+        success &= write.file->Write(write.data.data(), write.data.size(), write.offset) ==
+                   write.data.size();
+    }
+
+    if (journal != nullptr &&
+        (commits.size() > MAX_SNAPSHOTS || journal->GetSize() > MAX_JOURNAL_SIZE)) {
+        std::size_t keep = 0;
+        std::size_t kept_size = 0;
+        for (auto iter = commits.rbegin(); iter != commits.rend() && keep < MAX_SNAPSHOTS / 2;
+             ++iter) {
+            if (keep != 0 && kept_size + iter->size > MAX_JOURNAL_SIZE / 2) {
+                break;
+            }
+            kept_size += iter->size;
+            ++keep;
+        }
+        CompactImpl(keep);
+    }
+
+    if (!success) {
+        LOG_ERROR(Service_FS, "Failed to write committed save data to the host");
+    }
+    return success;
+}
+
+bool SaveDataJournal::AppendCommit(const std::vector<Undo>& undos) {
+    if (journal == nullptr) {
+        return false;
+    }
+
+    std::vector<u8> record(sizeof(CommitHeader));
+    for (const auto& undo : undos) {
+        UndoHeader header{};
+        header.type = static_cast<u8>(undo.type);
+        header.path_size = static_cast<u16>(undo.path.size());
+        header.new_path_size = static_cast<u16>(undo.new_path.size());
+        header.offset = undo.offset;
+        header.size = undo.size;
+        header.data_size = undo.data.size();
+
+        const auto offset = record.size();
+        record.resize(offset + sizeof(UndoHeader) + undo.path.size() + undo.new_path.size() +
+                      undo.data.size());
+        auto* out = record.data() + offset;
+        std::memcpy(out, &header, sizeof(UndoHeader));
+        out += sizeof(UndoHeader);
+        std::memcpy(out, undo.path.data(), undo.path.size());
+        out += undo.path.size();
+        std::memcpy(out, undo.new_path.data(), undo.new_path.size());
+        out += undo.new_path.size();
+        std::memcpy(out, undo.data.data(), undo.data.size());
+    }
+
+    CommitHeader header{};
+    header.magic = COMMIT_MAGIC;
+    header.num_undos = static_cast<u32>(undos.size());
+    header.commit_id = next_commit_id;
+    header.timestamp = GetTimestamp();
+    header.size = record.size() - sizeof(CommitHeader);
+    std::memcpy(record.data(), &header, sizeof(CommitHeader));
+
+    const auto offset = journal->GetSize();
+    if (journal->WriteBytes(record, offset) != record.size()) {
+        journal->Resize(offset);
+        return false;
+    }
+
+    commits.push_back({header.commit_id, header.timestamp, offset, record.size()});
+    ++next_commit_id;
+    return true;
+}
+
+std::vector<SaveDataJournal::Undo> SaveDataJournal::ReadCommit(const CommitInfo& commit) const {
+    const auto record = journal->ReadBytes(commit.size, commit.offset);
+    if (record.size() != commit.size) {
+        return {};
+    }
+
+    CommitHeader header{};
+    std::memcpy(&header, record.data(), sizeof(CommitHeader));
+
+    std::vector<Undo> undos;
+    std::size_t offset = sizeof(CommitHeader);
+    for (u32 i = 0; i < header.num_undos; ++i) {
+        UndoHeader undo_header{};
+        if (record.size() - offset < sizeof(UndoHeader)) {
+            break;
+        }
+        std::memcpy(&undo_header, record.data() + offset, sizeof(UndoHeader));
+        offset += sizeof(UndoHeader);
+
+        const std::size_t path_size = undo_header.path_size;
+        const std::size_t new_path_size = undo_header.new_path_size;
+        const auto data_size = static_cast<std::size_t>(undo_header.data_size);
+        if (record.size() - offset < path_size + new_path_size + data_size) {
+            break;
+        }
+
+        const auto* in = reinterpret_cast<const char*>(record.data() + offset);
+        Undo undo{static_cast<UndoType>(undo_header.type), std::string(in, path_size),
+                  std::string(in + path_size, new_path_size), undo_header.offset,
+                  undo_header.size};
+        const auto data_begin = record.begin() + offset + path_size + new_path_size;
+        undo.data.assign(data_begin, data_begin + data_size);
+        undos.push_back(std::move(undo));
+
+        offset += path_size + new_path_size + data_size;
+    }
+
+    return undos;
+}
+
+void SaveDataJournal::ApplyUndo(const Undo& undo) {
+    base_files.clear();
+    const auto parent = GetBaseDirectory(GetParentPath(undo.path));
+    const auto name = GetFilename(undo.path);
+
+    switch (undo.type) {
+    case UndoType::Write:
+        if (const auto file = root->GetFileRelative(undo.path); file != nullptr) {
+            file->WriteBytes(undo.data, undo.offset);
+        }
+        break;
+    case UndoType::Resize:
+        if (const auto file = root->GetFileRelative(undo.path); file != nullptr) {
+            file->Resize(undo.size);
+        }
+        break;
+    case UndoType::DeleteFile:
+        if (parent != nullptr) {
+            parent->DeleteFile(name);
+        }
+        break;
+    case UndoType::CreateFile: {
+        auto file = root->GetFileRelative(undo.path);
+        if (file == nullptr && parent != nullptr) {
+            file = parent->CreateFile(name);
+        }
+        if (file != nullptr) {
+            file->Resize(undo.data.size());
+            file->WriteBytes(undo.data);
+        }
+        break;
+    }
+    case UndoType::DeleteDirectory:
+        if (parent != nullptr) {
+            parent->DeleteSubdirectory(name);
+        }
+        break;
+    case UndoType::CreateDirectory:
+        if (parent != nullptr && parent->GetSubdirectory(name) == nullptr) {
+            parent->CreateSubdirectory(name);
+        }
+        break;
+    case UndoType::Rename:
+        if (const auto file = root->GetFileRelative(undo.new_path); file != nullptr) {
+            file->Rename(name);
+        } else if (const auto dir = GetBaseDirectory(undo.new_path); dir != nullptr) {
+            dir->Rename(name);
+        }
+        break;
+    default:
+        LOG_ERROR(Service_FS, "Unknown save data undo type {:02X}", static_cast<u8>(undo.type));
+        break;
+    }
+}
+
+std::vector<SaveDataSnapshot> SaveDataJournal::GetSnapshots() const {
+    std::lock_guard lock{mutex};
+
+    std::vector<SaveDataSnapshot> out;
+    out.reserve(commits.size());
+    for (const auto& commit : commits) {
+        out.push_back({commit.commit_id, commit.timestamp, commit.size});
+    }
+    return out;
+}
+
+bool SaveDataJournal::Revert(u64 commit_id) {
+    std::lock_guard lock{mutex};
+
+    const auto target =
+        std::find_if(commits.begin(), commits.end(),
+                     [commit_id](const auto& commit) { return commit.commit_id == commit_id; });
+    if (target == commits.end()) {
+        return false;
+    }
+
+    pending_files.clear();
+    created_files.clear();
+    for (auto iter = pending_undos.rbegin(); iter != pending_undos.rend(); ++iter) {
+        ApplyUndo(*iter);
+    }
+    pending_undos.clear();
+
+    for (auto commit = commits.end(); commit != target;) {
+        --commit;
+        const auto undos = ReadCommit(*commit);
+        for (auto iter = undos.rbegin(); iter != undos.rend(); ++iter) {
+            ApplyUndo(*iter);
+        }
+    }
+
+    journal->Resize(target->offset);
+    commits.erase(target, commits.end());
+    base_files.clear();
+    return true;
+}
+
+bool SaveDataJournal::Compact(std::size_t max_snapshots) {
+    std::lock_guard lock{mutex};
+    return CompactImpl(max_snapshots);
+}
+
+bool SaveDataJournal::CompactImpl(std::size_t max_snapshots) {
+    if (journal == nullptr || commits.size() <= max_snapshots) {
+        return true;
+    }
+
+    const auto dropped = commits.size() - max_snapshots;
+    const auto start = max_snapshots == 0 ? journal->GetSize() : commits[dropped].offset;
+    const auto kept = journal->ReadBytes(journal->GetSize() - start, start);
+    if (kept.size() != journal->GetSize() - start) {
+        return false;
+    }
+
+    if (!journal->Resize(sizeof(JournalHeader)) ||
+        journal->WriteBytes(kept, sizeof(JournalHeader)) != kept.size()) {
+        LOG_ERROR(Service_FS, "Failed to compact the save data journal");
+        journal->Resize(sizeof(JournalHeader));
+        commits.clear();
+        return false;
+    }
+
+    commits.erase(commits.begin(), commits.begin() + dropped);
+    for (auto& commit : commits) {
+        commit.offset -= start - sizeof(JournalHeader);
+    }
+    return true;
+}
+
+JournaledSaveDirectory::JournaledSaveDirectory(std::shared_ptr<SaveDataJournal> journal_,
+                                               std::string path_)
+    : journal{std::move(journal_)}, path{std::move(path_)} {}
+
+JournaledSaveDirectory::~JournaledSaveDirectory() = default;
+
+VirtualFile JournaledSaveDirectory::GetFile(std::string_view name) const {
+    const auto base = journal->GetBaseDirectory(path);
+    if (base == nullptr || base->GetFile(name) == nullptr) {
+        return nullptr;
+    }
+    return std::make_shared<JournaledSaveFile>(journal, JoinPath(path, name));
+}
+
+VirtualDir JournaledSaveDirectory::GetSubdirectory(std::string_view name) const {
+    const auto base = journal->GetBaseDirectory(path);
+    if (base == nullptr || base->GetSubdirectory(name) == nullptr) {
+        return nullptr;
+    }
+    return std::make_shared<JournaledSaveDirectory>(journal, JoinPath(path, name));
+}
+
+std::vector<VirtualFile> JournaledSaveDirectory::GetFiles() const {
+    const auto base = journal->GetBaseDirectory(path);
+    if (base == nullptr) {
+        return {};
+    }
+
+    std::vector<VirtualFile> out;
+    for (const auto& file : base->GetFiles()) {
+        out.push_back(
+            std::make_shared<JournaledSaveFile>(journal, JoinPath(path, file->GetName())));
+    }
+    return out;
+}
+
+std::vector<VirtualDir> JournaledSaveDirectory::GetSubdirectories() const {
+    const auto base = journal->GetBaseDirectory(path);
+    if (base == nullptr) {
+        return {};
+    }
+
+    std::vector<VirtualDir> out;
+    for (const auto& dir : base->GetSubdirectories()) {
+        out.push_back(
+            std::make_shared<JournaledSaveDirectory>(journal, JoinPath(path, dir->GetName())));
+    }
+    return out;
+}
+
+bool JournaledSaveDirectory::IsWritable() const {
+    return true;
+}
+
+bool JournaledSaveDirectory::IsReadable() const {
+    return true;
+}
+
+std::string JournaledSaveDirectory::GetName() const {
+    if (path.empty()) {
+        return journal->GetBaseDirectory(path)->GetName();
+    }
+    return GetFilename(path);
+}
+
+VirtualDir JournaledSaveDirectory::GetParentDirectory() const {
+    if (path.empty()) {
+        return nullptr;
+    }
+    return std::make_shared<JournaledSaveDirectory>(journal, GetParentPath(path));
+}
+
+VirtualDir JournaledSaveDirectory::CreateSubdirectory(std::string_view name) {
+    auto subdir_path = JoinPath(path, name);
+    if (!journal->CreateDirectory(subdir_path)) {
+        return nullptr;
+    }
+    return std::make_shared<JournaledSaveDirectory>(journal, std::move(subdir_path));
+}
+
+VirtualFile JournaledSaveDirectory::CreateFile(std::string_view name) {
+    auto file_path = JoinPath(path, name);
+    if (!journal->CreateFile(file_path)) {
+        return nullptr;
+    }
+    return std::make_shared<JournaledSaveFile>(journal, std::move(file_path));
+}
+
+bool JournaledSaveDirectory::DeleteSubdirectory(std::string_view name) {
+    return journal->DeleteDirectory(JoinPath(path, name));
+}
+
+bool JournaledSaveDirectory::DeleteSubdirectoryRecursive(std::string_view name) {
+    return journal->DeleteDirectory(JoinPath(path, name));
+}
+
+bool JournaledSaveDirectory::DeleteFile(std::string_view name) {
+    return journal->DeleteFile(JoinPath(path, name));
+}
+
+bool JournaledSaveDirectory::Rename(std::string_view name) {
+    if (!journal->Rename(path, name)) {
+        return false;
+    }
+    path = JoinPath(GetParentPath(path), name);
+    return true;
+}
+
+bool JournaledSaveDirectory::Commit() {
+    return journal->Commit();
+}
+
+const std::shared_ptr<SaveDataJournal>& JournaledSaveDirectory::GetJournal() const {
+    return journal;
+}
+
+} // namespace FileSys
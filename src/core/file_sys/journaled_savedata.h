@@ -0,0 +1,150 @@
+// Copyright 2020 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "common/common_types.h"
+#include "core/file_sys/vfs.h"
+
+namespace FileSys {
+
+// A commit recorded in the journal of a save data directory.
+struct SaveDataSnapshot {
+    u64 commit_id;
+    s64 timestamp;
+    // Bytes the commit takes up in the journal.
+    u64 journal_size;
+};
+
+// Journal of a save data directory on the host.
+//
+// Writes to files are kept in memory until they are committed, at which point only the blocks
+// whose contents actually changed are written to the host. The previous contents of those blocks,
+// along with how to undo the files and directories created, deleted or renamed since the last
+// commit, are appended to the journal file first. This allows reverting the save data to how it
+// was before any commit still in the journal. Old commits are dropped from the journal once it
+// grows too large.
+//
+// Paths are relative to the save data directory and separated by '/'.
+class SaveDataJournal {
+public:
+    SaveDataJournal(VirtualDir root, VirtualFile journal);
+    // Commits the changes still pending, so that closing the save data does not lose them.
+    ~SaveDataJournal();
+
+    VirtualDir GetBaseDirectory(const std::string& path) const;
+
+    std::size_t GetFileSize(const std::string& path) const;
+    std::size_t ReadFile(const std::string& path, u8* data, std::size_t length,
+                         std::size_t offset) const;
+    std::size_t WriteFile(const std::string& path, const u8* data, std::size_t length,
+                          std::size_t offset);
+    bool ResizeFile(const std::string& path, std::size_t new_size);
+
+    // Directory changes are applied to the host right away, and recorded to be undone.
+    bool CreateFile(const std::string& path);
+    bool DeleteFile(const std::string& path);
+    bool CreateDirectory(const std::string& path);
+    bool DeleteDirectory(const std::string& path);
+    bool Rename(const std::string& path, std::string_view new_name);
+
+    // Writes the pending changes to the host. Returns false if they could not be written.
+    bool Commit();
+
+    // Lists the commits in the journal, oldest first.
+    std::vector<SaveDataSnapshot> GetSnapshots() const;
+
+    // Discards the pending changes and reverts the save data to how it was before commit_id was
+    // made, dropping that and all later commits from the journal.
+    bool Revert(u64 commit_id);
+
+    // Drops the oldest commits from the journal until at most max_snapshots remain.
+    bool Compact(std::size_t max_snapshots);
+
+private:
+    // The contents of a file written since the last commit.
+    struct PendingFile {
+        std::size_t size;
+        // Blocks at or past this offset were truncated and read as zero unless written since.
+        std::size_t committed_size;
+        std::map<std::size_t, std::vector<u8>> blocks;
+    };
+
+    struct Undo;
+    struct CommitInfo {
+        u64 commit_id;
+        s64 timestamp;
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    void LoadJournal();
+    VirtualFile GetBaseFile(const std::string& path) const;
+    PendingFile* GetPendingFile(const std::string& path);
+    std::vector<u8> ReadBlock(const PendingFile& pending, const VirtualFile& base,
+                              std::size_t index) const;
+    void RecordDirectoryDeletion(const std::string& path, const VirtualDir& dir,
+                                 std::vector<Undo>& undos);
+    void MovePendingEntries(const std::string& path, const std::string& new_path);
+    bool CommitImpl();
+    bool AppendCommit(const std::vector<Undo>& undos);
+    std::vector<Undo> ReadCommit(const CommitInfo& commit) const;
+    void ApplyUndo(const Undo& undo);
+    bool CompactImpl(std::size_t max_snapshots);
+
+    VirtualDir root;
+    VirtualFile journal;
+
+    mutable std::mutex mutex;
+    std::map<std::string, PendingFile> pending_files;
+    // Files created since the last commit, whose previous contents need not be kept.
+    std::set<std::string> created_files;
+    // Undoes the directory changes made since the last commit, oldest first.
+    std::vector<Undo> pending_undos;
+
+    std::vector<CommitInfo> commits;
+    u64 next_commit_id = 1;
+
+    mutable std::map<std::string, VirtualFile> base_files;
+};
+
+// A directory of journaled save data, as handed out to the guest.
+class JournaledSaveDirectory : public VfsDirectory {
+public:
+    explicit JournaledSaveDirectory(std::shared_ptr<SaveDataJournal> journal,
+                                    std::string path = "");
+    ~JournaledSaveDirectory() override;
+
+    VirtualFile GetFile(std::string_view name) const override;
+    VirtualDir GetSubdirectory(std::string_view name) const override;
+    std::vector<VirtualFile> GetFiles() const override;
+    std::vector<VirtualDir> GetSubdirectories() const override;
+    bool IsWritable() const override;
+    bool IsReadable() const override;
+    std::string GetName() const override;
+    VirtualDir GetParentDirectory() const override;
+    VirtualDir CreateSubdirectory(std::string_view name) override;
+    VirtualFile CreateFile(std::string_view name) override;
+    bool DeleteSubdirectory(std::string_view name) override;
+    bool DeleteSubdirectoryRecursive(std::string_view name) override;
+    bool DeleteFile(std::string_view name) override;
+    bool Rename(std::string_view name) override;
+
+    bool Commit();
+
+    const std::shared_ptr<SaveDataJournal>& GetJournal() const;
+
+private:
+    std::shared_ptr<SaveDataJournal> journal;
+    std::string path;
+};
+
+} // namespace FileSys
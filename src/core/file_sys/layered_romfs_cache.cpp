@@ -0,0 +1,348 @@
+// Copyright 2020 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <map>
+#include <optional>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+
+#include "common/common_funcs.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/swap.h"
+#include "core/crypto/sha_util.h"
+#include "core/file_sys/fsmitm_romfsbuild.h"
+#include "core/file_sys/ips_layer.h"
+#include "core/file_sys/layered_romfs_cache.h"
+#include "core/file_sys/romfs.h"
+#include "core/file_sys/vfs_concat.h"
+#include "core/file_sys/vfs_layered.h"
+#include "core/file_sys/vfs_offset.h"
+#include "core/file_sys/vfs_vector.h"
+
+namespace FileSys {
+namespace {
+constexpr u32 CACHE_MAGIC = Common::MakeMagic('L', 'F', 'S', 'C');
+constexpr u32 CACHE_VERSION = 1;
+// Marks a file whose data comes from the base RomFS rather than a mod.
+constexpr u32 BASE_LAYER = 0xFFFFFFFF;
+
+struct TableLocation {
+    u64_le offset;
+    u64_le size;
+};
+static_assert(sizeof(TableLocation) == 0x10, "TableLocation has incorrect size.");
+
+struct RomFSHeader {
+    u64_le header_size;
+    std::array<TableLocation, 4> tables;
+    u64_le data_offset;
+};
+static_assert(sizeof(RomFSHeader) == 0x50, "RomFSHeader has incorrect size.");
+
+struct CacheHeader {
+    u32_le magic;
+    u32_le version;
+    Core::Crypto::SHA256Hash key;
+    u32_le num_blobs;
+    u32_le num_files;
+    u32_le name_size;
+    INSERT_PADDING_WORDS(1);
+};
+static_assert(sizeof(CacheHeader) == 0x38, "CacheHeader has incorrect size.");
+
+// Followed by size bytes of data, used for the RomFS header and metadata tables.
+struct CachedBlob {
+    u64_le offset;
+    u64_le size;
+};
+static_assert(sizeof(CachedBlob) == 0x10, "CachedBlob has incorrect size.");
+
+// Followed by path_size bytes of the path of the file within the RomFS.
+struct CachedFile {
+    u64_le offset;
+    u64_le size;
+    u64_le base_offset;
+    u32_le layer;
+    u16_le path_size;
+    u8 ips_patched;
+    INSERT_PADDING_BYTES(1);
+};
+static_assert(sizeof(CachedFile) == 0x20, "CachedFile has incorrect size.");
+
+template <typename T>
+void HashObject(Core::Crypto::SHA256Hasher& hasher, const T& object) {
+    hasher.Update(reinterpret_cast<const u8*>(&object), sizeof(T));
+}
+
+void HashString(Core::Crypto::SHA256Hasher& hasher, std::string_view string) {
+    HashObject(hasher, static_cast<u64>(string.size()));
+    hasher.Update(reinterpret_cast<const u8*>(string.data()), string.size());
+}
+
+// The build only depends on the names and sizes of the files in the mod directories; their
+// contents are read through the resolved files when the RomFS is used.
+void HashDirectoryListing(Core::Crypto::SHA256Hasher& hasher, const VirtualDir& dir) {
+    const auto by_name = [](const auto& lhs, const auto& rhs) {
+        return lhs->GetName() < rhs->GetName();
+    };
+
+    auto files = dir->GetFiles();
+    std::sort(files.begin(), files.end(), by_name);
+    HashObject(hasher, static_cast<u64>(files.size()));
+    for (const auto& file : files) {
+        HashString(hasher, file->GetName());
+        HashObject(hasher, static_cast<u64>(file->GetSize()));
+    }
+
+    auto subdirs = dir->GetSubdirectories();
+    std::sort(subdirs.begin(), subdirs.end(), by_name);
+    HashObject(hasher, static_cast<u64>(subdirs.size()));
+    for (const auto& subdir : subdirs) {
+        HashString(hasher, subdir->GetName());
+        HashDirectoryListing(hasher, subdir);
+    }
+}
+
+std::optional<Core::Crypto::SHA256Hash> CalculateCacheKey(
+    const VirtualFile& romfs, const std::vector<VirtualDir>& layers,
+    const std::vector<VirtualDir>& layers_ext) {
+    RomFSHeader header{};
+    if (romfs->ReadObject(&header) != sizeof(RomFSHeader) ||
+        header.header_size != sizeof(RomFSHeader)) {
+        return std::nullopt;
+    }
+
+    // The metadata tables describe every file of the base RomFS, including its offset and size.
+    u64 metadata_start = romfs->GetSize();
+    u64 metadata_end = 0;
+    for (const auto& table : header.tables) {
+        metadata_start = std::min<u64>(metadata_start, table.offset);
+        metadata_end = std::max<u64>(metadata_end, table.offset + table.size);
+    }
+    if (metadata_end <= metadata_start || metadata_end > romfs->GetSize()) {
+        return std::nullopt;
+    }
+
+    Core::Crypto::SHA256Hasher hasher;
+    HashObject(hasher, CACHE_VERSION);
+    HashObject(hasher, header);
+    hasher.Update(romfs->ReadBytes(metadata_end - metadata_start, metadata_start));
+
+    for (const auto* list : {&layers, &layers_ext}) {
+        HashObject(hasher, static_cast<u64>(list->size()));
+        for (const auto& layer : *list) {
+            HashDirectoryListing(hasher, layer);
+        }
+    }
+
+    return hasher.Finish();
+}
+
+VirtualFile LoadCachedRomFS(const std::string& cache_path, const Core::Crypto::SHA256Hash& key,
+                            const VirtualFile& romfs, const std::vector<VirtualDir>& layers,
+                            const VirtualDir& ext) {
+    std::vector<u8> data;
+    {
+        Common::FS::IOFile file{cache_path, "rb"};
+        if (!file.IsOpen()) {
+            return nullptr;
+        }
+        data.resize(file.GetSize());
+        if (file.ReadBytes(data.data(), data.size()) != data.size()) {
+            return nullptr;
+        }
+    }
+
+    std::size_t position = 0;
+    const auto read = [&data, &position](void* out, std::size_t size) {
+        if (size > data.size() - position) {
+            return false;
+        }
+        std::memcpy(out, data.data() + position, size);
+        position += size;
+        return true;
+    };
+
+    CacheHeader header{};
+    if (!read(&header, sizeof(CacheHeader)) || header.magic != CACHE_MAGIC ||
+        header.version != CACHE_VERSION || header.key != key) {
+        return nullptr;
+    }
+
+    std::string name(header.name_size, '\0');
+    if (!read(name.data(), name.size())) {
+        return nullptr;
+    }
+
+    std::multimap<u64, VirtualFile> layout;
+    for (u32 i = 0; i < header.num_blobs; ++i) {
+        CachedBlob blob{};
+        if (!read(&blob, sizeof(CachedBlob)) || blob.size > data.size() - position) {
+            return nullptr;
+        }
+        std::vector<u8> blob_data(blob.size);
+        read(blob_data.data(), blob_data.size());
+        layout.emplace(blob.offset, std::make_shared<VectorVfsFile>(std::move(blob_data)));
+    }
+
+    const auto romfs_size = romfs->GetSize();
+    const auto romfs_dir = romfs->GetContainingDirectory();
+    for (u32 i = 0; i < header.num_files; ++i) {
+        CachedFile entry{};
+        if (!read(&entry, sizeof(CachedFile))) {
+            return nullptr;
+        }
+        std::string path(entry.path_size, '\0');
+        if (!read(path.data(), path.size())) {
+            return nullptr;
+        }
+
+        VirtualFile source;
+        if (entry.layer == BASE_LAYER) {
+            if (entry.base_offset + entry.size > romfs_size) {
+                return nullptr;
+            }
+            source = std::make_shared<OffsetVfsFile>(romfs, entry.size, entry.base_offset,
+                                                     path.substr(path.rfind('/') + 1), romfs_dir);
+        } else if (entry.layer < layers.size()) {
+            source = layers[entry.layer]->GetFileRelative(path);
+        }
+
+        if (source != nullptr && entry.ips_patched != 0) {
+            const auto ips = ext == nullptr ? nullptr : ext->GetFileRelative(path + ".ips");
+            source = ips == nullptr ? nullptr : PatchIPS(source, ips);
+        }
+
+        // Anything that no longer matches the cached layout means the cache is stale.
+        if (source == nullptr || source->GetSize() != entry.size) {
+            return nullptr;
+        }
+        layout.emplace(entry.offset, std::move(source));
+    }
+
+    return ConcatenatedVfsFile::MakeConcatenatedFile(0, std::move(layout), std::move(name));
+}
+
+void SaveCachedRomFS(const std::string& cache_path, const Core::Crypto::SHA256Hash& key,
+                     const std::string& name, const std::multimap<u64, VirtualFile>& layout,
+                     const std::vector<RomFSBuildContext::FileSource>& sources,
+                     const std::vector<VirtualDir>& layers) {
+    std::vector<u8> data;
+    const auto write = [&data](const void* in, std::size_t size) {
+        const auto* bytes = static_cast<const u8*>(in);
+        data.insert(data.end(), bytes, bytes + size);
+    };
+
+    std::vector<CachedFile> files;
+    files.reserve(sources.size());
+    for (const auto& source : sources) {
+        CachedFile entry{};
+        entry.offset = source.offset;
+        entry.size = source.size;
+        entry.path_size = static_cast<u16>(source.path.size());
+        entry.ips_patched = source.source != source.original_source;
+
+        const auto layer = std::find_if(layers.begin(), layers.end(), [&source](const auto& dir) {
+            return dir->GetFileRelative(source.path) != nullptr;
+        });
+        if (layer != layers.end()) {
+            entry.layer = static_cast<u32>(std::distance(layers.begin(), layer));
+        } else if (const auto base = std::dynamic_pointer_cast<OffsetVfsFile>(
+                       source.original_source)) {
+            entry.layer = BASE_LAYER;
+            entry.base_offset = base->GetOffset();
+        } else {
+            LOG_WARNING(Loader, "Could not determine the origin of {}, not caching the RomFS",
+                        source.path);
+            return;
+        }
+        files.push_back(entry);
+    }
+
+    // Everything in the layout that is not file data is generated metadata.
+    std::unordered_set<const VfsFile*> source_files;
+    for (const auto& source : sources) {
+        source_files.insert(source.source.get());
+    }
+    std::vector<std::pair<u64, std::vector<u8>>> blobs;
+    for (const auto& [offset, file] : layout) {
+        if (!source_files.contains(file.get())) {
+            blobs.emplace_back(offset, file->ReadAllBytes());
+        }
+    }
+
+    CacheHeader header{};
+    header.magic = CACHE_MAGIC;
+    header.version = CACHE_VERSION;
+    header.key = key;
+    header.num_blobs = static_cast<u32>(blobs.size());
+    header.num_files = static_cast<u32>(files.size());
+    header.name_size = static_cast<u32>(name.size());
+    write(&header, sizeof(CacheHeader));
+    write(name.data(), name.size());
+
+    for (const auto& [offset, blob_data] : blobs) {
+        const CachedBlob blob{offset, blob_data.size()};
+        write(&blob, sizeof(CachedBlob));
+        write(blob_data.data(), blob_data.size());
+    }
+
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        write(&files[i], sizeof(CachedFile));
+        write(sources[i].path.data(), sources[i].path.size());
+    }
+
+    Common::FS::CreateFullPath(cache_path);
+    Common::FS::IOFile file{cache_path, "wb"};
+    if (!file.IsOpen() || file.WriteBytes(data.data(), data.size()) != data.size()) {
+        LOG_WARNING(Loader, "Failed to write LayeredFS cache to {}", cache_path);
+    }
+}
+} // Anonymous namespace
+
+VirtualFile CreateLayeredRomFS(VirtualFile romfs, std::vector<VirtualDir> layers,
+                               std::vector<VirtualDir> layers_ext, const std::string& cache_path) {
+    std::optional<Core::Crypto::SHA256Hash> key;
+    if (!cache_path.empty()) {
+        key = CalculateCacheKey(romfs, layers, layers_ext);
+    }
+
+    const auto ext = LayeredVfsDirectory::MakeLayeredDirectory(std::move(layers_ext));
+
+    if (key) {
+        if (auto cached = LoadCachedRomFS(cache_path, *key, romfs, layers, ext)) {
+            LOG_DEBUG(Loader, "Loaded LayeredFS RomFS layout from {}", cache_path);
+            return cached;
+        }
+    }
+
+    auto extracted = ExtractRomFS(romfs);
+    if (extracted == nullptr) {
+        return nullptr;
+    }
+
+    auto all_layers = layers;
+    all_layers.push_back(std::move(extracted));
+    const auto layered = LayeredVfsDirectory::MakeLayeredDirectory(std::move(all_layers));
+    if (layered == nullptr) {
+        return nullptr;
+    }
+
+    RomFSBuildContext ctx{layered, ext};
+    auto layout = ctx.Build();
+    const auto name = layered->GetName();
+
+    if (key) {
+        SaveCachedRomFS(cache_path, *key, name, layout, ctx.GetFileSources(), layers);
+    }
+
+    return ConcatenatedVfsFile::MakeConcatenatedFile(0, std::move(layout), name);
+}
+
+} // namespace FileSys
@@ -0,0 +1,26 @@
+// Copyright 2020 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include "core/file_sys/vfs.h"
+
+namespace FileSys {
+
+// Builds a RomFS with LayeredFS mods applied on top of a base RomFS. layers and layers_ext are the
+// mods' romfs and romfs_ext directories, highest priority first.
+//
+// Rebuilding the RomFS means extracting the whole base RomFS tree and merging every directory of
+// it with the mods, which takes a long time for large games. The result of a build (its metadata
+// tables and where the data of each file comes from) is therefore saved to cache_path, keyed by
+// the metadata of the base RomFS and the listings of the mod directories, and reused as long as
+// neither changes. An empty cache_path disables the cache.
+//
+// Returns nullptr on failure.
+VirtualFile CreateLayeredRomFS(VirtualFile romfs, std::vector<VirtualDir> layers,
+                               std::vector<VirtualDir> layers_ext, const std::string& cache_path);
+
+} // namespace FileSys
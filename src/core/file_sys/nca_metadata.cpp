@@ -22,21 +22,18 @@ CNMT::CNMT(VirtualFile file) {
         }
     }
 
-    for (u16 i = 0; i < header.number_content_entries; ++i) {
-        auto& next = content_records.emplace_back(ContentRecord{});
-        if (file->ReadObject(&next, sizeof(CNMTHeader) + i * sizeof(ContentRecord) +
-                                        header.table_offset) != sizeof(ContentRecord)) {
-            content_records.erase(content_records.end() - 1);
-        }
-    }
-
-    for (u16 i = 0; i < header.number_meta_entries; ++i) {
-        auto& next = meta_records.emplace_back(MetaRecord{});
-        if (file->ReadObject(&next, sizeof(CNMTHeader) + i * sizeof(MetaRecord) +
-                                        header.table_offset) != sizeof(MetaRecord)) {
-            meta_records.erase(meta_records.end() - 1);
-        }
-    }
+    // Each table is read in one go, as the file is usually behind an NCA decryption layer. Records
+    // past the end of the file are dropped.
+    const std::size_t table_offset = sizeof(CNMTHeader) + header.table_offset;
+
+    content_records.resize(header.number_content_entries);
+    content_records.resize(file->ReadArray(content_records.data(), content_records.size(),
+                                           table_offset) /
+                           sizeof(ContentRecord));
+
+    meta_records.resize(header.number_meta_entries);
+    meta_records.resize(file->ReadArray(meta_records.data(), meta_records.size(), table_offset) /
+                        sizeof(MetaRecord));
 }
 
 CNMT::CNMT(CNMTHeader header, OptionalHeader opt_header, std::vector<ContentRecord> content_records,
@@ -13,46 +13,56 @@
 
 namespace FileSys {
 namespace {
-template <bool Subsection, typename BlockType, typename BucketType>
-std::pair<std::size_t, std::size_t> SearchBucketEntry(u64 offset, const BlockType& block,
-                                                      const BucketType& buckets) {
-    if constexpr (Subsection) {
-        const auto& last_bucket = buckets[block.number_buckets - 1];
-        if (offset >= last_bucket.entries[last_bucket.number_entries].address_patch) {
-            return {block.number_buckets - 1, last_bucket.number_entries};
-        }
-    } else {
-        ASSERT_MSG(offset <= block.size, "Offset is out of bounds in BKTR relocation block.");
+template <typename Entry, typename BlockType, typename BucketType>
+std::vector<Entry> FlattenBuckets(const BlockType& block, const std::vector<BucketType>& buckets) {
+    std::vector<Entry> entries;
+    const auto num_buckets = std::min<std::size_t>(block.number_buckets, buckets.size());
+    for (std::size_t i = 0; i < num_buckets; ++i) {
+        const auto& bucket = buckets[i];
+        const auto num_entries =
+            std::min<std::size_t>(bucket.number_entries, bucket.entries.size());
+        entries.insert(entries.end(), bucket.entries.begin(), bucket.entries.begin() + num_entries);
     }
 
-    std::size_t bucket_id = std::count_if(
-        block.base_offsets.begin() + 1, block.base_offsets.begin() + block.number_buckets,
-        [&offset](u64 base_offset) { return base_offset <= offset; });
+    // Keep the entries appended after the on-disk ones of the last bucket.
+    if (!buckets.empty() && buckets.back().number_entries < buckets.back().entries.size()) {
+        const auto& bucket = buckets.back();
+        entries.insert(entries.end(), bucket.entries.begin() + bucket.number_entries,
+                       bucket.entries.end());
+    }
 
-    const auto& bucket = buckets[bucket_id];
+    return entries;
+}
 
-    if (bucket.number_entries == 1) {
-        return {bucket_id, 0};
-    }
+template <typename Entry>
+std::vector<u64> GetPatchAddresses(const std::vector<Entry>& entries) {
+    std::vector<u64> addresses(entries.size());
+    std::transform(entries.begin(), entries.end(), addresses.begin(),
+                   [](const Entry& entry) { return entry.address_patch; });
+    return addresses;
+}
 
-    std::size_t low = 0;
-    std::size_t mid = 0;
-    std::size_t high = bucket.number_entries - 1;
-    while (low <= high) {
-        mid = (low + high) / 2;
-        if (bucket.entries[mid].address_patch > offset) {
-            high = mid - 1;
-        } else {
-            if (mid == bucket.number_entries - 1 ||
-                bucket.entries[mid + 1].address_patch > offset) {
-                return {bucket_id, mid};
-            }
+std::vector<RelocationEntry> FlattenRelocationBuckets(
+    const RelocationBlock& block, const std::vector<RelocationBucket>& buckets) {
+    auto entries = FlattenBuckets<RelocationEntry>(block, buckets);
+    entries.push_back({block.size, 0, 0});
+    return entries;
+}
 
-            low = mid + 1;
-        }
+std::array<u8, 16> CalculateIV(const std::array<u8, 8>& section_ctr, u64 offset, u32 ctr) {
+    std::array<u8, 16> iv{};
+    for (std::size_t i = 0; i < section_ctr.size(); ++i)
+        iv[i] = section_ctr[0x8 - i - 1];
+    offset >>= 4;
+    for (std::size_t i = 0; i < sizeof(u64); ++i) {
+        iv[0xF - i] = static_cast<u8>(offset & 0xFF);
+        offset >>= 8;
     }
-
-    UNREACHABLE_MSG("Offset could not be found in BKTR block.");
+    for (std::size_t i = 0; i < sizeof(u32); ++i) {
+        iv[0x7 - i] = static_cast<u8>(ctr & 0xFF);
+        ctr >>= 8;
+    }
+    return iv;
 }
 } // Anonymous namespace
 
@@ -61,122 +71,99 @@ BKTR::BKTR(VirtualFile base_romfs_, VirtualFile bktr_romfs_, RelocationBlock rel
            std::vector<SubsectionBucket> subsection_buckets_, bool is_encrypted_,
            Core::Crypto::Key128 key_, u64 base_offset_, u64 ivfc_offset_,
            std::array<u8, 8> section_ctr_)
-    : relocation(relocation_), relocation_buckets(std::move(relocation_buckets_)),
-      subsection(subsection_), subsection_buckets(std::move(subsection_buckets_)),
-      base_romfs(std::move(base_romfs_)), bktr_romfs(std::move(bktr_romfs_)),
-      encrypted(is_encrypted_), key(key_), base_offset(base_offset_), ivfc_offset(ivfc_offset_),
-      section_ctr(section_ctr_) {
-    for (std::size_t i = 0; i < relocation.number_buckets - 1; ++i) {
-        relocation_buckets[i].entries.push_back({relocation.base_offsets[i + 1], 0, 0});
-    }
-
-    for (std::size_t i = 0; i < subsection.number_buckets - 1; ++i) {
-        subsection_buckets[i].entries.push_back({subsection_buckets[i + 1].entries[0].address_patch,
-                                                 {0},
-                                                 subsection_buckets[i + 1].entries[0].ctr});
-    }
-
-    relocation_buckets.back().entries.push_back({relocation.size, 0, 0});
-}
+    : size(relocation_.size),
+      relocation_entries(FlattenRelocationBuckets(relocation_, relocation_buckets_)),
+      relocation_index(GetPatchAddresses(relocation_entries)),
+      subsection_entries(FlattenBuckets<SubsectionEntry>(subsection_, subsection_buckets_)),
+      subsection_index(GetPatchAddresses(subsection_entries)), base_romfs(std::move(base_romfs_)),
+      bktr_romfs(std::move(bktr_romfs_)), encrypted(is_encrypted_), key(key_),
+      base_offset(base_offset_), ivfc_offset(ivfc_offset_), section_ctr(section_ctr_) {}
 
 BKTR::~BKTR() = default;
 
 std::size_t BKTR::Read(u8* data, std::size_t length, std::size_t offset) const {
     // Read out of bounds.
-    if (offset >= relocation.size)
+    if (offset >= size || offset < relocation_entries.front().address_patch) {
         return 0;
-    const auto relocation = GetRelocationEntry(offset);
-    const auto section_offset = offset - relocation.address_patch + relocation.address_source;
-    const auto bktr_read = relocation.from_patch;
-
-    const auto next_relocation = GetNextRelocationEntry(offset);
-
-    if (offset + length > next_relocation.address_patch) {
-        const u64 partition = next_relocation.address_patch - offset;
-        return Read(data, partition, offset) +
-               Read(data + partition, length - partition, offset + partition);
     }
+    length = std::min<u64>(length, size - offset);
+
+    // The sentinel entry at the end guarantees every entry found has a successor.
+    std::size_t total_read = 0;
+    for (auto i = relocation_index.Find(offset); total_read != length; ++i) {
+        const auto& relocation = relocation_entries[i];
+        const auto current_offset = offset + total_read;
+        const auto to_read = std::min<u64>(
+            length - total_read, relocation_entries[i + 1].address_patch - current_offset);
+        const auto section_offset =
+            current_offset - relocation.address_patch + relocation.address_source;
+
+        std::size_t read;
+        if (relocation.from_patch) {
+            read = ReadPatch(data + total_read, to_read, section_offset);
+        } else {
+            ASSERT_MSG(section_offset >= ivfc_offset, "Offset calculation negative.");
+            read = base_romfs->Read(data + total_read, to_read, section_offset - ivfc_offset);
+        }
 
-    if (!bktr_read) {
-        ASSERT_MSG(section_offset >= ivfc_offset, "Offset calculation negative.");
-        return base_romfs->Read(data, length, section_offset - ivfc_offset);
+        total_read += read;
+        if (read != to_read) {
+            break;
+        }
     }
 
+    return total_read;
+}
+
+std::size_t BKTR::ReadPatch(u8* data, std::size_t length, u64 section_offset) const {
     if (!encrypted) {
         return bktr_romfs->Read(data, length, section_offset);
     }
-
-    const auto subsection = GetSubsectionEntry(section_offset);
-    Core::Crypto::AESCipher<Core::Crypto::Key128> cipher(key, Core::Crypto::Mode::CTR);
-
-    // Calculate AES IV
-    std::array<u8, 16> iv{};
-    auto subsection_ctr = subsection.ctr;
-    auto offset_iv = section_offset + base_offset;
-    for (std::size_t i = 0; i < section_ctr.size(); ++i)
-        iv[i] = section_ctr[0x8 - i - 1];
-    offset_iv >>= 4;
-    for (std::size_t i = 0; i < sizeof(u64); ++i) {
-        iv[0xF - i] = static_cast<u8>(offset_iv & 0xFF);
-        offset_iv >>= 8;
-    }
-    for (std::size_t i = 0; i < sizeof(u32); ++i) {
-        iv[0x7 - i] = static_cast<u8>(subsection_ctr & 0xFF);
-        subsection_ctr >>= 8;
+    if (section_offset < subsection_entries.front().address_patch) {
+        return 0;
     }
-    cipher.SetIV(iv);
 
-    const auto next_subsection = GetNextSubsectionEntry(section_offset);
+    Core::Crypto::AESCipher<Core::Crypto::Key128> cipher(key, Core::Crypto::Mode::CTR);
 
-    if (section_offset + length > next_subsection.address_patch) {
-        const u64 partition = next_subsection.address_patch - section_offset;
-        return Read(data, partition, offset) +
-               Read(data + partition, length - partition, offset + partition);
-    }
+    std::size_t total_read = 0;
+    for (auto i = subsection_index.Find(section_offset);
+         total_read != length && i + 1 < subsection_entries.size(); ++i) {
+        const auto ctr = subsection_entries[i].ctr;
+        const auto current_offset = section_offset + total_read;
+        const auto to_read = std::min<u64>(
+            length - total_read, subsection_entries[i + 1].address_patch - current_offset);
+        u8* const out = data + total_read;
+
+        // A read starting within an AES block has to decrypt that block as a whole.
+        const auto block_offset = current_offset & 0xF;
+        const auto head = block_offset == 0 ? 0 : std::min<u64>(to_read, 0x10 - block_offset);
+        std::size_t read = 0;
+        if (head != 0) {
+            std::array<u8, 0x10> block{};
+            const auto raw_read =
+                bktr_romfs->Read(block.data(), block.size(), current_offset - block_offset);
+            cipher.SetIV(CalculateIV(section_ctr, current_offset + base_offset, ctr));
+            cipher.Transcode(block.data(), block.size(), block.data(), Core::Crypto::Op::Decrypt);
+
+            read = raw_read > block_offset ? std::min<u64>(head, raw_read - block_offset) : 0;
+            std::memcpy(out, block.data() + block_offset, read);
+        }
 
-    const auto block_offset = section_offset & 0xF;
-    if (block_offset != 0) {
-        auto block = bktr_romfs->ReadBytes(0x10, section_offset & ~0xF);
-        cipher.Transcode(block.data(), block.size(), block.data(), Core::Crypto::Op::Decrypt);
-        if (length + block_offset < 0x10) {
-            std::memcpy(data, block.data() + block_offset, std::min(length, block.size()));
-            return std::min(length, block.size());
+        if (read == head && read != to_read) {
+            const auto raw_read =
+                bktr_romfs->Read(out + read, to_read - read, current_offset + read);
+            cipher.SetIV(CalculateIV(section_ctr, current_offset + read + base_offset, ctr));
+            cipher.Transcode(out + read, raw_read, out + read, Core::Crypto::Op::Decrypt);
+            read += raw_read;
         }
 
-        const auto read = 0x10 - block_offset;
-        std::memcpy(data, block.data() + block_offset, read);
-        return read + Read(data + read, length - read, offset + read);
+        total_read += read;
+        if (read != to_read) {
+            break;
+        }
     }
 
-    const auto raw_read = bktr_romfs->Read(data, length, section_offset);
-    cipher.Transcode(data, raw_read, data, Core::Crypto::Op::Decrypt);
-    return raw_read;
-}
-
-RelocationEntry BKTR::GetRelocationEntry(u64 offset) const {
-    const auto res = SearchBucketEntry<false>(offset, relocation, relocation_buckets);
-    return relocation_buckets[res.first].entries[res.second];
-}
-
-RelocationEntry BKTR::GetNextRelocationEntry(u64 offset) const {
-    const auto res = SearchBucketEntry<false>(offset, relocation, relocation_buckets);
-    const auto bucket = relocation_buckets[res.first];
-    if (res.second + 1 < bucket.entries.size())
-        return bucket.entries[res.second + 1];
-    return relocation_buckets[res.first + 1].entries[0];
-}
-
-SubsectionEntry BKTR::GetSubsectionEntry(u64 offset) const {
-    const auto res = SearchBucketEntry<true>(offset, subsection, subsection_buckets);
-    return subsection_buckets[res.first].entries[res.second];
-}
-
-SubsectionEntry BKTR::GetNextSubsectionEntry(u64 offset) const {
-    const auto res = SearchBucketEntry<true>(offset, subsection, subsection_buckets);
-    const auto bucket = subsection_buckets[res.first];
-    if (res.second + 1 < bucket.entries.size())
-        return bucket.entries[res.second + 1];
-    return subsection_buckets[res.first + 1].entries[0];
+    return total_read;
 }
 
 std::string BKTR::GetName() const {
@@ -184,7 +171,7 @@ std::string BKTR::GetName() const {
 }
 
 std::size_t BKTR::GetSize() const {
-    return relocation.size;
+    return size;
 }
 
 bool BKTR::Resize(std::size_t new_size) {
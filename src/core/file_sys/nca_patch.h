@@ -12,6 +12,7 @@
 #include "common/common_types.h"
 #include "common/swap.h"
 #include "core/crypto/key_manager.h"
+#include "core/file_sys/interval_index.h"
 
 namespace FileSys {
 
@@ -117,16 +118,21 @@ public:
     bool Rename(std::string_view name) override;
 
 private:
-    RelocationEntry GetRelocationEntry(u64 offset) const;
-    RelocationEntry GetNextRelocationEntry(u64 offset) const;
-
-    SubsectionEntry GetSubsectionEntry(u64 offset) const;
-    SubsectionEntry GetNextSubsectionEntry(u64 offset) const;
-
-    RelocationBlock relocation;
-    std::vector<RelocationBucket> relocation_buckets;
-    SubsectionBlock subsection;
-    std::vector<SubsectionBucket> subsection_buckets;
+    // Reads from the patch RomFS, decrypting it with the counter of each subsection it covers.
+    std::size_t ReadPatch(u8* data, std::size_t length, u64 section_offset) const;
+
+    // Size of the patched RomFS.
+    u64 size;
+
+    // The entries of every bucket flattened into one array sorted by patched address, ending in a
+    // sentinel entry at the end of the RomFS. The buckets only exist to make the on-disk format
+    // pageable and would otherwise add a second search level to every read.
+    std::vector<RelocationEntry> relocation_entries;
+    IntervalIndex relocation_index;
+    // Flattened the same way, sorted by address within the patch RomFS. The NCA appends an entry
+    // for the BKTR headers and a sentinel at the end of the section.
+    std::vector<SubsectionEntry> subsection_entries;
+    IntervalIndex subsection_index;
 
     // Should be the raw base romfs, decrypted.
     VirtualFile base_romfs;
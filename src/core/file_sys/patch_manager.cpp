@@ -6,6 +6,7 @@
 #include <array>
 #include <cstddef>
 #include <cstring>
+#include <set>
 
 #include "common/file_util.h"
 #include "common/hex_util.h"
@@ -16,6 +17,7 @@
 #include "core/file_sys/content_archive.h"
 #include "core/file_sys/control_metadata.h"
 #include "core/file_sys/ips_layer.h"
+#include "core/file_sys/layered_romfs_cache.h"
 #include "core/file_sys/patch_manager.h"
 #include "core/file_sys/registered_cache.h"
 #include "core/file_sys/romfs.h"
@@ -110,6 +112,49 @@ void AppendCommaIfNotEmpty(std::string& to, std::string_view with) {
 bool IsDirValidAndNonEmpty(const VirtualDir& dir) {
     return dir != nullptr && (!dir->GetFiles().empty() || !dir->GetSubdirectories().empty());
 }
+
+std::string GetPatchModName(const VirtualFile& patch_file) {
+    return patch_file->GetContainingDirectory()->GetParentDirectory()->GetName();
+}
+
+// Warns about patches from different mods writing to the same bytes, as only the patch applied
+// last takes effect there.
+void LogPatchConflicts(const std::vector<std::pair<VirtualFile, IPSPatchSet>>& patches) {
+    struct Write {
+        u64 begin;
+        u64 end;
+        std::size_t patch;
+    };
+
+    std::vector<Write> writes;
+    for (std::size_t i = 0; i < patches.size(); ++i) {
+        for (const auto& record : patches[i].second.records) {
+            if (record.size != 0) {
+                writes.push_back({record.offset, u64{record.offset} + record.size, i});
+            }
+        }
+    }
+    std::sort(writes.begin(), writes.end(),
+              [](const Write& lhs, const Write& rhs) { return lhs.begin < rhs.begin; });
+
+    std::set<std::pair<std::size_t, std::size_t>> conflicts;
+    std::vector<Write> active;
+    for (const auto& write : writes) {
+        std::erase_if(active, [&write](const Write& other) { return other.end <= write.begin; });
+        for (const auto& other : active) {
+            if (other.patch != write.patch) {
+                conflicts.insert(std::minmax(other.patch, write.patch));
+            }
+        }
+        active.push_back(write);
+    }
+
+    for (const auto& [first, second] : conflicts) {
+        LOG_WARNING(Loader, "    - Patch {} from mod \"{}\" overrides parts of {} from mod \"{}\"",
+                    patches[second].first->GetName(), GetPatchModName(patches[second].first),
+                    patches[first].first->GetName(), GetPatchModName(patches[first].first));
+    }
+}
 } // Anonymous namespace
 
 PatchManager::PatchManager(u64 title_id_,
@@ -183,11 +228,11 @@ VirtualDir PatchManager::PatchExeFS(VirtualDir exefs) const {
     return exefs;
 }
 
-std::vector<VirtualFile> PatchManager::CollectPatches(const std::vector<VirtualDir>& patch_dirs,
-                                                      const std::string& build_id) const {
+std::vector<PatchManager::NSOPatch> PatchManager::CollectPatches(
+    const std::vector<VirtualDir>& patch_dirs, const std::string& build_id) const {
     const auto& disabled = Settings::values.disabled_addons[title_id];
 
-    std::vector<VirtualFile> out;
+    std::vector<NSOPatch> out;
     out.reserve(patch_dirs.size());
     for (const auto& subdir : patch_dirs) {
         if (std::find(disabled.cbegin(), disabled.cend(), subdir->GetName()) != disabled.cend())
@@ -196,25 +241,32 @@ std::vector<VirtualFile> PatchManager::CollectPatches(const std::vector<VirtualD
         auto exefs_dir = FindSubdirectoryCaseless(subdir, "exefs");
         if (exefs_dir != nullptr) {
             for (const auto& file : exefs_dir->GetFiles()) {
-                if (file->GetExtension() == "ips") {
+                const auto extension = file->GetExtension();
+                if (extension == "ips") {
                     auto name = file->GetName();
                     const auto p1 = name.substr(0, name.find('.'));
                     const auto this_build_id = p1.substr(0, p1.find_last_not_of('0') + 1);
 
-                    if (build_id == this_build_id)
-                        out.push_back(file);
-                } else if (file->GetExtension() == "pchtxt") {
-                    IPSwitchCompiler compiler{file};
-                    if (!compiler.IsValid())
+                    if (build_id != this_build_id)
                         continue;
+                } else if (extension != "pchtxt") {
+                    continue;
+                }
 
-                    auto this_build_id = Common::HexToString(compiler.GetBuildID());
+                auto patch_set = LoadPatchSet(file, title_id, subdir->GetName());
+                if (!patch_set)
+                    continue;
+
+                if (extension == "pchtxt") {
+                    auto this_build_id = Common::HexToString(patch_set->build_id);
                     this_build_id =
                         this_build_id.substr(0, this_build_id.find_last_not_of('0') + 1);
 
-                    if (build_id == this_build_id)
-                        out.push_back(file);
+                    if (build_id != this_build_id)
+                        continue;
                 }
+
+                out.emplace_back(file, std::move(*patch_set));
             }
         }
     }
@@ -234,6 +286,13 @@ std::vector<u8> PatchManager::PatchNSO(const std::vector<u8>& nso, const std::st
         return nso;
     }
 
+    auto out = nso;
+    PatchNSO(header, std::span<u8>(out).subspan(sizeof(header)), name);
+    return out;
+}
+
+void PatchManager::PatchNSO(const Loader::NSOHeader& header, std::span<u8> program_image,
+                            const std::string& name) const {
     const auto build_id_raw = Common::HexToString(header.build_id);
     const auto build_id = build_id_raw.substr(0, build_id_raw.find_last_not_of('0') + 1);
 
@@ -245,48 +304,36 @@ std::vector<u8> PatchManager::PatchNSO(const std::vector<u8>& nso, const std::st
             const auto nso_dir = GetOrCreateDirectoryRelative(dump_dir, "/nso");
             const auto file = nso_dir->CreateFile(fmt::format("{}-{}.nso", name, build_id));
 
-            file->Resize(nso.size());
-            file->WriteBytes(nso);
+            file->Resize(sizeof(header) + program_image.size());
+            file->WriteObject(header);
+            file->Write(program_image.data(), program_image.size(), sizeof(header));
         }
     }
 
-    LOG_INFO(Loader, "Patching NSO for name={}, build_id={}", name, build_id);
-
     const auto load_dir = fs_controller.GetModificationLoadRoot(title_id);
     if (load_dir == nullptr) {
         LOG_ERROR(Loader, "Cannot load mods for invalid title_id={:016X}", title_id);
-        return nso;
+        return;
     }
 
     auto patch_dirs = load_dir->GetSubdirectories();
     std::sort(patch_dirs.begin(), patch_dirs.end(),
               [](const VirtualDir& l, const VirtualDir& r) { return l->GetName() < r->GetName(); });
     const auto patches = CollectPatches(patch_dirs, build_id);
-
-    auto out = nso;
-    for (const auto& patch_file : patches) {
-        if (patch_file->GetExtension() == "ips") {
-            LOG_INFO(Loader, "    - Applying IPS patch from mod \"{}\"",
-                     patch_file->GetContainingDirectory()->GetParentDirectory()->GetName());
-            const auto patched = PatchIPS(std::make_shared<VectorVfsFile>(out), patch_file);
-            if (patched != nullptr)
-                out = patched->ReadAllBytes();
-        } else if (patch_file->GetExtension() == "pchtxt") {
-            LOG_INFO(Loader, "    - Applying IPSwitch patch from mod \"{}\"",
-                     patch_file->GetContainingDirectory()->GetParentDirectory()->GetName());
-            const IPSwitchCompiler compiler{patch_file};
-            const auto patched = compiler.Apply(std::make_shared<VectorVfsFile>(out));
-            if (patched != nullptr)
-                out = patched->ReadAllBytes();
-        }
+    if (patches.empty()) {
+        return;
     }
 
-    if (out.size() < sizeof(Loader::NSOHeader)) {
-        return nso;
-    }
+    LOG_INFO(Loader, "Patching NSO for name={}, build_id={}", name, build_id);
+    LogPatchConflicts(patches);
 
-    std::memcpy(out.data(), &header, sizeof(header));
-    return out;
+    // Patch offsets count from the start of the NSO header.
+    for (const auto& [patch_file, patch_set] : patches) {
+        LOG_INFO(Loader, "    - Applying {} patch from mod \"{}\"",
+                 patch_file->GetExtension() == "ips" ? "IPS" : "IPSwitch",
+                 GetPatchModName(patch_file));
+        patch_set.Apply(program_image, sizeof(Loader::NSOHeader));
+    }
 }
 
 bool PatchManager::HasNSOPatch(const BuildID& build_id_) const {
@@ -351,11 +398,6 @@ static void ApplyLayeredFS(VirtualFile& romfs, u64 title_id, ContentRecordType t
         return;
     }
 
-    auto extracted = ExtractRomFS(romfs);
-    if (extracted == nullptr) {
-        return;
-    }
-
     const auto& disabled = Settings::values.disabled_addons[title_id];
     auto patch_dirs = load_dir->GetSubdirectories();
     std::sort(patch_dirs.begin(), patch_dirs.end(),
@@ -384,16 +426,11 @@ static void ApplyLayeredFS(VirtualFile& romfs, u64 title_id, ContentRecordType t
         return;
     }
 
-    layers.push_back(std::move(extracted));
-
-    auto layered = LayeredVfsDirectory::MakeLayeredDirectory(std::move(layers));
-    if (layered == nullptr) {
-        return;
-    }
-
-    auto layered_ext = LayeredVfsDirectory::MakeLayeredDirectory(std::move(layers_ext));
+    const auto cache_path = fmt::format("{}layeredfs/{:016X}_{:02X}.bin",
+                                        Common::FS::GetUserPath(Common::FS::UserPath::CacheDir),
+                                        title_id, static_cast<u8>(type));
 
-    auto packed = CreateRomFS(std::move(layered), std::move(layered_ext));
+    auto packed = CreateLayeredRomFS(romfs, std::move(layers), std::move(layers_ext), cache_path);
     if (packed == nullptr) {
         return;
     }
@@ -7,8 +7,11 @@
 #include <map>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
+#include <utility>
 #include "common/common_types.h"
+#include "core/file_sys/ips_layer.h"
 #include "core/file_sys/nca_metadata.h"
 #include "core/file_sys/vfs_types.h"
 #include "core/memory/dmnt_cheat_types.h"
@@ -17,6 +20,10 @@ namespace Core {
 class System;
 }
 
+namespace Loader {
+struct NSOHeader;
+}
+
 namespace Service::FileSystem {
 class FileSystemController;
 }
@@ -51,6 +58,11 @@ public:
     [[nodiscard]] std::vector<u8> PatchNSO(const std::vector<u8>& nso,
                                            const std::string& name) const;
 
+    // Patches the program image of the NSO with the given header in place, so that the image does
+    // not have to be copied along with the header first.
+    void PatchNSO(const Loader::NSOHeader& header, std::span<u8> program_image,
+                  const std::string& name) const;
+
     // Checks to see if PatchNSO() will have any effect given the NSO's build ID.
     // Used to prevent expensive copies in NSO loader.
     [[nodiscard]] bool HasNSOPatch(const BuildID& build_id) const;
@@ -83,8 +95,10 @@ public:
     [[nodiscard]] Metadata ParseControlNCA(const NCA& nca) const;
 
 private:
-    [[nodiscard]] std::vector<VirtualFile> CollectPatches(const std::vector<VirtualDir>& patch_dirs,
-                                                          const std::string& build_id) const;
+    using NSOPatch = std::pair<VirtualFile, IPSPatchSet>;
+
+    [[nodiscard]] std::vector<NSOPatch> CollectPatches(const std::vector<VirtualDir>& patch_dirs,
+                                                       const std::string& build_id) const;
 
     u64 title_id;
     const Service::FileSystem::FileSystemController& fs_controller;
@@ -5,12 +5,12 @@
 #include <algorithm>
 #include <random>
 #include <regex>
-#include <mbedtls/sha256.h>
 #include "common/assert.h"
 #include "common/file_util.h"
 #include "common/hex_util.h"
 #include "common/logging/log.h"
 #include "core/crypto/key_manager.h"
+#include "core/crypto/sha_util.h"
 #include "core/file_sys/card_image.h"
 #include "core/file_sys/content_archive.h"
 #include "core/file_sys/nca_metadata.h"
@@ -62,7 +62,7 @@ static std::string GetRelativePathFromNcaID(const std::array<u8, 16>& nca_id, bo
                            Common::HexToString(nca_id, second_hex_upper));
 
     Core::Crypto::SHA256Hash hash{};
-    mbedtls_sha256_ret(nca_id.data(), nca_id.size(), hash.data(), 0);
+    hash = Core::Crypto::CalculateSHA256(nca_id.data(), nca_id.size());
     return fmt::format(cnmt_suffix ? "/000000{:02X}/{}.cnmt.nca" : "/000000{:02X}/{}.nca", hash[0],
                        Common::HexToString(nca_id, second_hex_upper));
 }
@@ -141,7 +141,7 @@ bool PlaceholderCache::Create(const NcaID& id, u64 size) const {
     }
 
     Core::Crypto::SHA256Hash hash{};
-    mbedtls_sha256_ret(id.data(), id.size(), hash.data(), 0);
+    hash = Core::Crypto::CalculateSHA256(id.data(), id.size());
     const auto dirname = fmt::format("000000{:02X}", hash[0]);
 
     const auto dir2 = GetOrCreateDirectoryRelative(dir, dirname);
@@ -165,7 +165,7 @@ bool PlaceholderCache::Delete(const NcaID& id) const {
     }
 
     Core::Crypto::SHA256Hash hash{};
-    mbedtls_sha256_ret(id.data(), id.size(), hash.data(), 0);
+    hash = Core::Crypto::CalculateSHA256(id.data(), id.size());
     const auto dirname = fmt::format("000000{:02X}", hash[0]);
 
     const auto dir2 = GetOrCreateDirectoryRelative(dir, dirname);
@@ -538,6 +538,108 @@ std::vector<ContentProviderEntry> RegisteredCache::ListEntriesFilter(
     return out;
 }
 
+static bool DeleteNCA(const VirtualDir& dir, const NcaID& id) {
+    const auto path = GetRelativePathFromNcaID(id, false, true, false);
+
+    const bool isFile = dir->GetFileRelative(path) != nullptr;
+    const bool isDir = dir->GetDirectoryRelative(path) != nullptr;
+
+    if (isFile) {
+        return dir->DeleteFile(path);
+    } else if (isDir) {
+        return dir->DeleteSubdirectoryRecursive(path);
+    }
+
+    return false;
+}
+
+// Passes the writes of a copy through to the file being installed, hashing the data along the way
+// as long as it is written from start to end.
+class HashingVfsFile final : public VfsFile {
+public:
+    explicit HashingVfsFile(VirtualFile base_) : base(std::move(base_)) {}
+
+    std::string GetName() const override {
+        return base->GetName();
+    }
+
+    std::size_t GetSize() const override {
+        return base->GetSize();
+    }
+
+    bool Resize(std::size_t new_size) override {
+        return base->Resize(new_size);
+    }
+
+    VirtualDir GetContainingDirectory() const override {
+        return base->GetContainingDirectory();
+    }
+
+    bool IsWritable() const override {
+        return base->IsWritable();
+    }
+
+    bool IsReadable() const override {
+        return base->IsReadable();
+    }
+
+    std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override {
+        return base->Read(data, length, offset);
+    }
+
+    std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override {
+        const auto written = base->Write(data, length, offset);
+        if (in_order && offset == hashed_size) {
+            hasher.Update(data, written);
+            hashed_size += written;
+        } else if (written != 0) {
+            in_order = false;
+        }
+        return written;
+    }
+
+    bool Rename(std::string_view name) override {
+        return base->Rename(name);
+    }
+
+    // Returns the hash of the written data, or std::nullopt if it was not written in order.
+    std::optional<Core::Crypto::SHA256Hash> GetHash() {
+        if (!in_order || hashed_size != base->GetSize()) {
+            return std::nullopt;
+        }
+        return hasher.Finish();
+    }
+
+private:
+    VirtualFile base;
+    Core::Crypto::SHA256Hasher hasher;
+    std::size_t hashed_size = 0;
+    bool in_order = true;
+};
+
+// Hashes an installed NCA and compares the result to the hash recorded for it in the CNMT.
+static bool VerifyInstalledNCA(const VirtualFile& file, const Core::Crypto::SHA256Hash& expected) {
+    const auto size = file->GetSize();
+    if (const auto span = file->GetSpan(0, size); span.size() == size) {
+        return Core::Crypto::CalculateSHA256(span.data(), span.size()) == expected;
+    }
+
+    Core::Crypto::SHA256Hasher hasher;
+    std::vector<u8> buffer(std::min(VFS_RC_LARGE_COPY_BLOCK, size));
+    bool read_failed = false;
+    for (std::size_t offset = 0; offset < size; offset += buffer.size()) {
+        const auto length = std::min(buffer.size(), size - offset);
+        if (file->Read(buffer.data(), length, offset) != length) {
+            read_failed = true;
+            break;
+        }
+        hasher.Update(buffer.data(), length);
+    }
+
+    const auto hash = hasher.Finish();
+    return !read_failed && hash == expected;
+}
+
 static std::shared_ptr<NCA> GetNCAFromNSPForID(const NSP& nsp, const NcaID& id) {
     auto file = nsp.GetFile(fmt::format("{}.nca", Common::HexToString(id, false)));
     if (file == nullptr) {
@@ -595,7 +697,9 @@ InstallResult RegisteredCache::InstallEntry(const NSP& nsp, bool overwrite_if_ex
         return res;
     }
 
-    // Install all the other NCAs
+    // Install all the other NCAs, each checked against the hash recorded for it in the CNMT as it
+    // is copied.
+    std::vector<NcaID> installed_ids{meta_id};
     for (const auto& record : cnmt.GetContentRecords()) {
         // Ignore DeltaFragments, they are not useful to us
         if (record.type == ContentRecordType::DeltaFragment) {
@@ -605,10 +709,21 @@ InstallResult RegisteredCache::InstallEntry(const NSP& nsp, bool overwrite_if_ex
         if (nca == nullptr) {
             return InstallResult::ErrorCopyFailed;
         }
-        const auto res2 = RawInstallNCA(*nca, copy, overwrite_if_exists, record.nca_id);
+        const auto res2 =
+            RawInstallNCA(*nca, copy, overwrite_if_exists, record.nca_id, record.hash);
+        if (res2 == InstallResult::ErrorHashMismatch) {
+            // Don't leave a title that fails to verify registered.
+            installed_ids.push_back(record.nca_id);
+            for (const auto& id : installed_ids) {
+                DeleteNCA(dir, id);
+            }
+            Refresh();
+            return res2;
+        }
         if (res2 != InstallResult::Success) {
             return res2;
         }
+        installed_ids.push_back(record.nca_id);
     }
 
     Refresh();
@@ -637,7 +752,7 @@ InstallResult RegisteredCache::InstallEntry(const NCA& nca, TitleType type,
     const OptionalHeader opt_header{0, 0};
     ContentRecord c_rec{{}, {}, {}, GetCRTypeFromNCAType(nca.GetType()), {}};
     const auto& data = nca.GetBaseFile()->ReadBytes(0x100000);
-    mbedtls_sha256_ret(data.data(), data.size(), c_rec.hash.data(), 0);
+    c_rec.hash = Core::Crypto::CalculateSHA256(data);
     std::memcpy(&c_rec.nca_id, &c_rec.hash, 16);
     const CNMT new_cnmt(header, opt_header, {c_rec}, {});
     if (!RawInstallYuzuMeta(new_cnmt)) {
@@ -647,20 +762,7 @@ InstallResult RegisteredCache::InstallEntry(const NCA& nca, TitleType type,
 }
 
 bool RegisteredCache::RemoveExistingEntry(u64 title_id) const {
-    const auto delete_nca = [this](const NcaID& id) {
-        const auto path = GetRelativePathFromNcaID(id, false, true, false);
-
-        const bool isFile = dir->GetFileRelative(path) != nullptr;
-        const bool isDir = dir->GetDirectoryRelative(path) != nullptr;
-
-        if (isFile) {
-            return dir->DeleteFile(path);
-        } else if (isDir) {
-            return dir->DeleteSubdirectoryRecursive(path);
-        }
-
-        return false;
-    };
+    const auto delete_nca = [this](const NcaID& id) { return DeleteNCA(dir, id); };
 
     // If an entry exists in the registered cache, remove it
     if (HasEntry(title_id, ContentRecordType::Meta)) {
@@ -697,9 +799,9 @@ bool RegisteredCache::RemoveExistingEntry(u64 title_id) const {
     return false;
 }
 
-InstallResult RegisteredCache::RawInstallNCA(const NCA& nca, const VfsCopyFunction& copy,
-                                             bool overwrite_if_exists,
-                                             std::optional<NcaID> override_id) {
+InstallResult RegisteredCache::RawInstallNCA(
+    const NCA& nca, const VfsCopyFunction& copy, bool overwrite_if_exists,
+    std::optional<NcaID> override_id, std::optional<Core::Crypto::SHA256Hash> expected_hash) {
     const auto in = nca.GetBaseFile();
     Core::Crypto::SHA256Hash hash{};
 
@@ -712,7 +814,7 @@ InstallResult RegisteredCache::RawInstallNCA(const NCA& nca, const VfsCopyFuncti
         id = *override_id;
     } else {
         const auto& data = in->ReadBytes(0x100000);
-        mbedtls_sha256_ret(data.data(), data.size(), hash.data(), 0);
+        hash = Core::Crypto::CalculateSHA256(data);
         memcpy(id.data(), hash.data(), 16);
     }
 
@@ -734,8 +836,24 @@ InstallResult RegisteredCache::RawInstallNCA(const NCA& nca, const VfsCopyFuncti
     if (out == nullptr) {
         return InstallResult::ErrorCopyFailed;
     }
-    return copy(in, out, VFS_RC_LARGE_COPY_BLOCK) ? InstallResult::Success
-                                                  : InstallResult::ErrorCopyFailed;
+    if (!expected_hash) {
+        return copy(in, out, VFS_RC_LARGE_COPY_BLOCK) ? InstallResult::Success
+                                                      : InstallResult::ErrorCopyFailed;
+    }
+
+    const auto hashing_out = std::make_shared<HashingVfsFile>(out);
+    if (!copy(in, hashing_out, VFS_RC_LARGE_COPY_BLOCK)) {
+        return InstallResult::ErrorCopyFailed;
+    }
+
+    // Copy functions that did not write the NCA in order have it read back instead.
+    const auto copied_hash = hashing_out->GetHash();
+    if (copied_hash ? *copied_hash != *expected_hash : !VerifyInstalledNCA(out, *expected_hash)) {
+        LOG_ERROR(Loader, "Installed NCA {} does not match the hash in its CNMT.",
+                  Common::HexToString(id, false));
+        return InstallResult::ErrorHashMismatch;
+    }
+    return InstallResult::Success;
 }
 
 bool RegisteredCache::RawInstallYuzuMeta(const CNMT& cnmt) {
@@ -7,6 +7,7 @@
 #include <array>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 #include <boost/container/flat_map.hpp>
@@ -38,6 +39,7 @@ enum class InstallResult {
     ErrorAlreadyExists,
     ErrorCopyFailed,
     ErrorMetaFailed,
+    ErrorHashMismatch,
 };
 
 struct ContentProviderEntry {
@@ -156,18 +158,19 @@ public:
         std::optional<u64> title_id = {}) const override;
 
     // Raw copies all the ncas from the xci/nsp to the csache. Does some quick checks to make sure
-    // there is a meta NCA and all of them are accessible.
+    // there is a meta NCA and all of them are accessible. Each NCA is hashed as it is copied and
+    // checked against the hash in the CNMT. If any NCA does not match, the title is removed again.
     InstallResult InstallEntry(const XCI& xci, bool overwrite_if_exists = false,
-                               const VfsCopyFunction& copy = &VfsRawCopy);
+                               const VfsCopyFunction& copy = &VfsPipelinedCopy);
     InstallResult InstallEntry(const NSP& nsp, bool overwrite_if_exists = false,
-                               const VfsCopyFunction& copy = &VfsRawCopy);
+                               const VfsCopyFunction& copy = &VfsPipelinedCopy);
 
     // Due to the fact that we must use Meta-type NCAs to determine the existance of files, this
     // poses quite a challenge. Instead of creating a new meta NCA for this file, yuzu will create a
     // dir inside the NAND called 'yuzu_meta' and store the raw CNMT there.
     // TODO(DarkLordZach): Author real meta-type NCAs and install those.
     InstallResult InstallEntry(const NCA& nca, TitleType type, bool overwrite_if_exists = false,
-                               const VfsCopyFunction& copy = &VfsRawCopy);
+                               const VfsCopyFunction& copy = &VfsPipelinedCopy);
 
     // Removes an existing entry based on title id
     bool RemoveExistingEntry(u64 title_id) const;
@@ -183,8 +186,11 @@ private:
     std::optional<NcaID> GetNcaIDFromMetadata(u64 title_id, ContentRecordType type) const;
     VirtualFile GetFileAtID(NcaID id) const;
     VirtualFile OpenFileOrDirectoryConcat(const VirtualDir& dir, std::string_view path) const;
+    // With expected_hash set, the copied NCA is hashed and ErrorHashMismatch returned if it
+    // differs. The mismatching NCA is left installed for the caller to remove.
     InstallResult RawInstallNCA(const NCA& nca, const VfsCopyFunction& copy,
-                                bool overwrite_if_exists, std::optional<NcaID> override_id = {});
+                                bool overwrite_if_exists, std::optional<NcaID> override_id = {},
+                                std::optional<Core::Crypto::SHA256Hash> expected_hash = {});
     bool RawInstallYuzuMeta(const CNMT& cnmt);
 
     VirtualDir dir;
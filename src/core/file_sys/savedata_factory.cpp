@@ -7,13 +7,16 @@
 #include "common/common_types.h"
 #include "common/logging/log.h"
 #include "core/core.h"
+#include "core/file_sys/journaled_savedata.h"
 #include "core/file_sys/savedata_factory.h"
 #include "core/file_sys/vfs.h"
 #include "core/hle/kernel/process.h"
+#include "core/settings.h"
 
 namespace FileSys {
 
 constexpr char SAVE_DATA_SIZE_FILENAME[] = ".yuzu_save_size";
+constexpr char SAVE_DATA_JOURNAL_SUFFIX[] = ".journal";
 
 namespace {
 
@@ -94,7 +97,7 @@ ResultVal<VirtualDir> SaveDataFactory::Create(SaveDataSpaceId space,
         return RESULT_UNKNOWN;
     }
 
-    return MakeResult<VirtualDir>(std::move(out));
+    return MakeResult<VirtualDir>(OpenJournaled(std::move(out), save_directory, meta.type));
 }
 
 ResultVal<VirtualDir> SaveDataFactory::Open(SaveDataSpaceId space,
@@ -115,7 +118,35 @@ ResultVal<VirtualDir> SaveDataFactory::Open(SaveDataSpaceId space,
         return RESULT_UNKNOWN;
     }
 
-    return MakeResult<VirtualDir>(std::move(out));
+    return MakeResult<VirtualDir>(OpenJournaled(std::move(out), save_directory, meta.type));
+}
+
+VirtualDir SaveDataFactory::OpenJournaled(VirtualDir save, const std::string& save_directory,
+                                          SaveDataType type) const {
+    if (!Settings::values.journal_save_data ||
+        (type != SaveDataType::SaveData && type != SaveDataType::DeviceSaveData)) {
+        return save;
+    }
+
+    auto journal = journals[save_directory].lock();
+    if (journal == nullptr) {
+        // The journal is kept next to the save data, so that it is not visible to the guest.
+        const auto journal_path = save_directory + SAVE_DATA_JOURNAL_SUFFIX;
+        auto journal_file = dir->GetFileRelative(journal_path);
+        if (journal_file == nullptr) {
+            journal_file = dir->CreateFileRelative(journal_path);
+        }
+        if (journal_file == nullptr) {
+            LOG_WARNING(Service_FS, "Could not open save data journal at {}, commits will not be "
+                                    "revertible",
+                        journal_path);
+        }
+
+        journal = std::make_shared<SaveDataJournal>(std::move(save), std::move(journal_file));
+        journals.insert_or_assign(save_directory, journal);
+    }
+
+    return std::make_shared<JournaledSaveDirectory>(std::move(journal));
 }
 
 VirtualDir SaveDataFactory::GetSaveDataSpaceDirectory(SaveDataSpaceId space) const {
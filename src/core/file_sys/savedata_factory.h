@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <map>
 #include <memory>
 #include <string>
 #include "common/common_funcs.h"
@@ -18,6 +19,8 @@ class System;
 
 namespace FileSys {
 
+class SaveDataJournal;
+
 enum class SaveDataSpaceId : u8 {
     NandSystem = 0,
     NandUser = 1,
@@ -105,8 +108,16 @@ public:
                            SaveDataSize new_value) const;
 
 private:
+    // Game save data is journaled if enabled, so that commits only write the blocks that changed
+    // and can be reverted.
+    VirtualDir OpenJournaled(VirtualDir save, const std::string& save_directory,
+                             SaveDataType type) const;
+
     VirtualDir dir;
     Core::System& system;
+
+    // Save data opened more than once shares its journal and the changes pending in it.
+    mutable std::map<std::string, std::weak_ptr<SaveDataJournal>> journals;
 };
 
 } // namespace FileSys
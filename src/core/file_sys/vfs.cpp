@@ -3,11 +3,16 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <numeric>
 #include <string>
+#include <thread>
+#include <utility>
 #include "common/common_paths.h"
 #include "common/file_util.h"
 #include "common/logging/backend.h"
+#include "common/threadsafe_queue.h"
 #include "core/file_sys/mode.h"
 #include "core/file_sys/vfs.h"
 
@@ -188,6 +193,10 @@ std::vector<u8> VfsFile::ReadAllBytes() const {
     return ReadBytes(GetSize());
 }
 
+std::span<const u8> VfsFile::GetSpan(std::size_t offset, std::size_t length) const {
+    return {};
+}
+
 bool VfsFile::WriteByte(u8 data, std::size_t offset) {
     return Write(&data, 1, offset) == 1;
 }
@@ -532,6 +541,70 @@ bool VfsRawCopy(const VirtualFile& src, const VirtualFile& dest, std::size_t blo
     return true;
 }
 
+bool VfsPipelinedCopy(const VirtualFile& src, const VirtualFile& dest, std::size_t block_size) {
+    return VfsPipelinedCopyWithProgress(src, dest, block_size, {});
+}
+
+bool VfsPipelinedCopyWithProgress(const VirtualFile& src, const VirtualFile& dest,
+                                  std::size_t block_size, const VfsCopyProgressCallback& progress) {
+    if (src == nullptr || dest == nullptr || !src->IsReadable() || !dest->IsWritable())
+        return false;
+
+    const auto size = src->GetSize();
+    if (size <= block_size) {
+        if (progress && !progress(size))
+            return false;
+        return VfsRawCopy(src, dest, block_size);
+    }
+    if (!dest->Resize(size))
+        return false;
+
+    // Buffers cycle from the reader to the writer through filled_buffers, tagged with the offset
+    // they were read from, and back through free_buffers. An offset of size stops the writer.
+    constexpr std::size_t NUM_BUFFERS = 3;
+    std::array<std::vector<u8>, NUM_BUFFERS> buffers;
+    Common::SPSCQueue<std::size_t> free_buffers;
+    Common::SPSCQueue<std::pair<std::size_t, std::size_t>> filled_buffers;
+    std::atomic_bool write_failed{false};
+
+    for (std::size_t i = 0; i < NUM_BUFFERS; ++i) {
+        buffers[i].resize(block_size);
+        free_buffers.Push(i);
+    }
+
+    std::thread writer([&] {
+        while (true) {
+            const auto [index, offset] = filled_buffers.PopWait();
+            if (offset == size) {
+                return;
+            }
+
+            const auto length = std::min(block_size, size - offset);
+            if (!write_failed && dest->Write(buffers[index].data(), length, offset) != length) {
+                write_failed = true;
+            }
+            free_buffers.Push(index);
+        }
+    });
+
+    bool read_failed = false;
+    for (std::size_t offset = 0; offset < size && !write_failed; offset += block_size) {
+        const auto index = free_buffers.PopWait();
+        const auto length = std::min(block_size, size - offset);
+        if (src->Read(buffers[index].data(), length, offset) != length ||
+            (progress && !progress(length))) {
+            read_failed = true;
+            break;
+        }
+        filled_buffers.Push(std::make_pair(index, offset));
+    }
+
+    filled_buffers.Push(std::make_pair(std::size_t{0}, size));
+    writer.join();
+
+    return !read_failed && !write_failed;
+}
+
 bool VfsRawCopyD(const VirtualDir& src, const VirtualDir& dest, std::size_t block_size) {
     if (src == nullptr || dest == nullptr || !src->IsReadable() || !dest->IsWritable())
         return false;
@@ -8,6 +8,7 @@
 #include <map>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <type_traits>
@@ -113,6 +114,12 @@ public:
     // 0)'
     virtual std::vector<u8> ReadAllBytes() const;
 
+    // Returns a view of up to length bytes starting at offset directly into memory backing the
+    // file, avoiding the copy made by Read. Files that are not backed by memory return an empty
+    // span, in which case the caller should fall back to Read. The view is invalidated by writes
+    // to, resizing of, or closing of the file.
+    virtual std::span<const u8> GetSpan(std::size_t offset, std::size_t length) const;
+
     // Reads an array of type T, size number_elements starting at offset.
     // Returns the number of bytes (sizeof(T)*number_elements) read successfully.
     template <typename T>
@@ -302,6 +309,19 @@ bool DeepEquals(const VirtualFile& file1, const VirtualFile& file2,
 // directory of src/dest.
 bool VfsRawCopy(const VirtualFile& src, const VirtualFile& dest, std::size_t block_size = 0x1000);
 
+// Called with the number of bytes read after each block of a copy. Returning false cancels it.
+using VfsCopyProgressCallback = std::function<bool(std::size_t)>;
+
+// Performs the same copy as VfsRawCopy, but reads on the calling thread while a worker thread
+// writes the previously read blocks, so that reading and writing overlap. src and dest must not
+// be accessed by anything else for the duration of the copy.
+bool VfsPipelinedCopy(const VirtualFile& src, const VirtualFile& dest,
+                      std::size_t block_size = 0x1000);
+
+// Performs the same copy as VfsPipelinedCopy, reporting the progress after each block read.
+bool VfsPipelinedCopyWithProgress(const VirtualFile& src, const VirtualFile& dest,
+                                  std::size_t block_size, const VfsCopyProgressCallback& progress);
+
 // A method that performs a similar function to VfsRawCopy above, but instead copies entire
 // directories. It suffers the same performance penalties as above and an implementation-specific
 // Copy should always be preferred.
@@ -0,0 +1,194 @@
+// Copyright 2020 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <string>
+
+#include <fmt/format.h>
+
+#include "common/cityhash.h"
+#include "common/file_util.h"
+#include "core/file_sys/vfs_cached.h"
+#include "core/file_sys/vfs_offset.h"
+#include "core/file_sys/vfs_real.h"
+
+namespace FileSys {
+
+namespace {
+// Reads this large are streaming reads; caching them would only evict the small, hot blocks.
+constexpr std::size_t MAX_CACHED_READ_SIZE = BlockCache::BLOCK_SIZE * 4;
+
+// Ids of files without a known source. Hashed source ids could collide with these, but are
+// unlikely to be this small.
+std::atomic<u64> next_source_id{};
+} // Anonymous namespace
+
+std::optional<std::size_t> BlockCache::Read(u64 source_id, u64 block_index,
+                                            std::size_t block_offset, u8* data,
+                                            std::size_t length) {
+    const Key key{source_id, block_index};
+    auto& shard = GetShard(key);
+
+    std::lock_guard lock{shard.mutex};
+    const auto iter = shard.index.find(key);
+    if (iter == shard.index.end()) {
+        shard.misses.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+    shard.hits.fetch_add(1, std::memory_order_relaxed);
+
+    shard.entries.splice(shard.entries.begin(), shard.entries, iter->second);
+
+    const auto& block = iter->second->data;
+    if (block_offset >= block.size()) {
+        return 0;
+    }
+    const auto read = std::min(length, block.size() - block_offset);
+    std::memcpy(data, block.data() + block_offset, read);
+    return read;
+}
+
+void BlockCache::Insert(u64 source_id, u64 block_index, std::vector<u8> block) {
+    const Key key{source_id, block_index};
+    auto& shard = GetShard(key);
+
+    std::lock_guard lock{shard.mutex};
+    const auto iter = shard.index.find(key);
+    if (iter != shard.index.end()) {
+        // Another thread filled the same block first.
+        shard.entries.splice(shard.entries.begin(), shard.entries, iter->second);
+        return;
+    }
+
+    if (shard.entries.size() >= BLOCKS_PER_SHARD) {
+        shard.index.erase(shard.entries.back().key);
+        shard.entries.pop_back();
+    }
+
+    shard.entries.push_front({key, std::move(block)});
+    shard.index.emplace(key, shard.entries.begin());
+}
+
+BlockCache::Stats BlockCache::GetStats() const {
+    Stats stats{};
+    for (const auto& shard : shards) {
+        stats.hits += shard.hits.load(std::memory_order_relaxed);
+        stats.misses += shard.misses.load(std::memory_order_relaxed);
+    }
+    return stats;
+}
+
+BlockCache::Shard& BlockCache::GetShard(const Key& key) {
+    return shards[Common::PairHash{}(key) % NUM_SHARDS];
+}
+
+std::optional<u64> GetHostStorageId(const VirtualFile& file) {
+    std::size_t offset = 0;
+    VirtualFile current = file;
+    while (const auto* offset_file = dynamic_cast<const OffsetVfsFile*>(current.get())) {
+        offset += offset_file->GetOffset();
+        current = offset_file->GetBaseFile();
+    }
+
+    if (dynamic_cast<const RealVfsFile*>(current.get()) == nullptr) {
+        return std::nullopt;
+    }
+
+    const auto path = current->GetFullPath();
+    const auto last_write_time = Common::FS::GetLastWriteTime(path);
+    if (last_write_time == 0) {
+        return std::nullopt;
+    }
+
+    const auto identity = fmt::format("{}:{}:{}:{}:{}", path, current->GetSize(), last_write_time,
+                                      offset, file->GetSize());
+    return Common::CityHash64(identity.data(), identity.size());
+}
+
+CachedVfsFile::CachedVfsFile(VirtualFile base_, std::optional<u64> source_id_)
+    : base(std::move(base_)),
+      source_id(source_id_ ? *source_id_
+                           : next_source_id.fetch_add(1, std::memory_order_relaxed)) {}
+
+CachedVfsFile::~CachedVfsFile() = default;
+
+std::string CachedVfsFile::GetName() const {
+    return base->GetName();
+}
+
+std::size_t CachedVfsFile::GetSize() const {
+    return base->GetSize();
+}
+
+bool CachedVfsFile::Resize(std::size_t new_size) {
+    return false;
+}
+
+VirtualDir CachedVfsFile::GetContainingDirectory() const {
+    return base->GetContainingDirectory();
+}
+
+bool CachedVfsFile::IsWritable() const {
+    return false;
+}
+
+bool CachedVfsFile::IsReadable() const {
+    return true;
+}
+
+std::size_t CachedVfsFile::Read(u8* data, std::size_t length, std::size_t offset) const {
+    if (length >= MAX_CACHED_READ_SIZE) {
+        return base->Read(data, length, offset);
+    }
+
+    const auto size = base->GetSize();
+    if (offset >= size) {
+        return 0;
+    }
+    length = std::min(length, size - offset);
+
+    auto& cache = BlockCache::Instance();
+    std::size_t total_read = 0;
+    while (length != 0) {
+        const u64 block_index = offset / BlockCache::BLOCK_SIZE;
+        const auto block_offset = offset % BlockCache::BLOCK_SIZE;
+        const auto to_read = std::min(length, BlockCache::BLOCK_SIZE - block_offset);
+
+        auto read = cache.Read(source_id, block_index, block_offset, data, to_read);
+        if (!read) {
+            const auto block_start = block_index * BlockCache::BLOCK_SIZE;
+            std::vector<u8> block(std::min(BlockCache::BLOCK_SIZE, size - block_start));
+            block.resize(base->Read(block.data(), block.size(), block_start));
+
+            read = block_offset < block.size() ? std::min(to_read, block.size() - block_offset) : 0;
+            if (*read != 0) {
+                std::memcpy(data, block.data() + block_offset, *read);
+            }
+            cache.Insert(source_id, block_index, std::move(block));
+        }
+
+        total_read += *read;
+        if (*read != to_read) {
+            break;
+        }
+
+        data += to_read;
+        length -= to_read;
+        offset += to_read;
+    }
+
+    return total_read;
+}
+
+std::size_t CachedVfsFile::Write(const u8* data, std::size_t length, std::size_t offset) {
+    return 0;
+}
+
+bool CachedVfsFile::Rename(std::string_view name) {
+    return base->Rename(name);
+}
+
+} // namespace FileSys
@@ -0,0 +1,116 @@
+// Copyright 2020 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/hash.h"
+#include "core/file_sys/vfs.h"
+
+namespace FileSys {
+
+// A bounded, process-wide LRU cache of file blocks. Entries are keyed by the source id of the
+// CachedVfsFile that produced them and the block index within that file. The cache is split into
+// shards, each with its own lock, so that lookups from different threads rarely contend.
+class BlockCache {
+public:
+    static constexpr std::size_t BLOCK_SIZE = 0x4000;
+
+    struct Stats {
+        u64 hits;
+        u64 misses;
+    };
+
+    static BlockCache& Instance() {
+        static BlockCache instance;
+        return instance;
+    }
+
+    BlockCache(const BlockCache&) = delete;
+    BlockCache& operator=(const BlockCache&) = delete;
+
+    BlockCache(BlockCache&&) = delete;
+    BlockCache& operator=(BlockCache&&) = delete;
+
+    /// Copies up to length bytes starting at block_offset within a cached block into data.
+    /// Returns the number of bytes copied, or std::nullopt if the block is not cached.
+    std::optional<std::size_t> Read(u64 source_id, u64 block_index, std::size_t block_offset,
+                                    u8* data, std::size_t length);
+
+    /// Inserts a block, evicting the least recently used block of its shard if it is full.
+    void Insert(u64 source_id, u64 block_index, std::vector<u8> block);
+
+    /// Returns the number of lookups that found or missed their block, summed over all shards.
+    Stats GetStats() const;
+
+private:
+    BlockCache() = default;
+
+    static constexpr std::size_t NUM_SHARDS = 16;
+    static constexpr std::size_t BLOCKS_PER_SHARD = 256;
+
+    using Key = std::pair<u64, u64>;
+
+    struct Entry {
+        Key key;
+        std::vector<u8> data;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        // Most recently used entries are at the front.
+        std::list<Entry> entries;
+        std::unordered_map<Key, std::list<Entry>::iterator, Common::PairHash> index;
+        // Atomic so that they can be read without taking the lock.
+        std::atomic<u64> hits{};
+        std::atomic<u64> misses{};
+    };
+
+    Shard& GetShard(const Key& key);
+
+    std::array<Shard, NUM_SHARDS> shards;
+};
+
+// Identifies the contents of a file backed by a range of a host file, from the path, size and
+// modification time of the host file and the offset of the range. Returns std::nullopt for files
+// read through any other layer.
+std::optional<u64> GetHostStorageId(const VirtualFile& file);
+
+// Sits on top of a read-only VfsFile and serves small reads out of the BlockCache, so that
+// repeatedly accessed blocks of an expensive file (e.g. a decrypted NCA section) are only read
+// from the underlying file once.
+class CachedVfsFile : public VfsFile {
+public:
+    // Files created with the same source_id share their cached blocks, so it must identify the
+    // contents of base. Without one, the file gets an id of its own.
+    explicit CachedVfsFile(VirtualFile base, std::optional<u64> source_id = std::nullopt);
+    ~CachedVfsFile() override;
+
+    std::string GetName() const override;
+    std::size_t GetSize() const override;
+    bool Resize(std::size_t new_size) override;
+    VirtualDir GetContainingDirectory() const override;
+    bool IsWritable() const override;
+    bool IsReadable() const override;
+    std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
+    std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override;
+    bool Rename(std::string_view name) override;
+
+private:
+    VirtualFile base;
+    u64 source_id;
+};
+
+} // namespace FileSys
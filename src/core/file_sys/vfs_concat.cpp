@@ -23,18 +23,22 @@ static bool VerifyConcatenationMapContinuity(const std::multimap<u64, VirtualFil
     return map.begin()->first == 0;
 }
 
-ConcatenatedVfsFile::ConcatenatedVfsFile(std::vector<VirtualFile> files_, std::string name)
-    : name(std::move(name)) {
+static std::multimap<u64, VirtualFile> MakeContinuousMap(const std::vector<VirtualFile>& files) {
+    std::multimap<u64, VirtualFile> map;
     std::size_t next_offset = 0;
-    for (const auto& file : files_) {
-        files.emplace(next_offset, file);
+    for (const auto& file : files) {
+        map.emplace(next_offset, file);
         next_offset += file->GetSize();
     }
+    return map;
 }
 
+ConcatenatedVfsFile::ConcatenatedVfsFile(std::vector<VirtualFile> files_, std::string name)
+    : ConcatenatedVfsFile(MakeContinuousMap(files_), std::move(name)) {}
+
 ConcatenatedVfsFile::ConcatenatedVfsFile(std::multimap<u64, VirtualFile> files_, std::string name)
-    : files(std::move(files_)), name(std::move(name)) {
-    ASSERT(VerifyConcatenationMapContinuity(files));
+    : files(BuildEntries(files_)), index(GetEntryOffsets(files)), name(std::move(name)) {
+    ASSERT(VerifyConcatenationMapContinuity(files_));
 }
 
 ConcatenatedVfsFile::~ConcatenatedVfsFile() = default;
@@ -81,14 +85,14 @@ std::string ConcatenatedVfsFile::GetName() const {
     if (!name.empty()) {
         return name;
     }
-    return files.begin()->second->GetName();
+    return files.front().file->GetName();
 }
 
 std::size_t ConcatenatedVfsFile::GetSize() const {
     if (files.empty()) {
         return 0;
     }
-    return files.rbegin()->first + files.rbegin()->second->GetSize();
+    return files.back().offset + files.back().size;
 }
 
 bool ConcatenatedVfsFile::Resize(std::size_t new_size) {
@@ -99,7 +103,7 @@ VirtualDir ConcatenatedVfsFile::GetContainingDirectory() const {
     if (files.empty()) {
         return nullptr;
     }
-    return files.begin()->second->GetContainingDirectory();
+    return files.front().file->GetContainingDirectory();
 }
 
 bool ConcatenatedVfsFile::IsWritable() const {
@@ -111,25 +115,26 @@ bool ConcatenatedVfsFile::IsReadable() const {
 }
 
 std::size_t ConcatenatedVfsFile::Read(u8* data, std::size_t length, std::size_t offset) const {
-    auto entry = --files.end();
-    for (auto iter = files.begin(); iter != files.end(); ++iter) {
-        if (iter->first > offset) {
-            entry = --iter;
-            break;
-        }
+    const auto size = GetSize();
+    if (offset >= size) {
+        return 0;
     }
+    length = std::min<u64>(length, size - offset);
 
-    if (entry->first + entry->second->GetSize() <= offset)
-        return 0;
+    std::size_t total_read = 0;
+    for (auto i = index.Find(offset); total_read != length; ++i) {
+        const auto& entry = files[i];
+        const auto entry_offset = offset + total_read - entry.offset;
+        const auto to_read = std::min<u64>(length - total_read, entry.size - entry_offset);
 
-    const auto read_in =
-        std::min<u64>(entry->first + entry->second->GetSize() - offset, entry->second->GetSize());
-    if (length > read_in) {
-        return entry->second->Read(data, read_in, offset - entry->first) +
-               Read(data + read_in, length - read_in, offset + read_in);
+        const auto read = entry.file->Read(data + total_read, to_read, entry_offset);
+        total_read += read;
+        if (read != to_read) {
+            break;
+        }
     }
 
-    return entry->second->Read(data, std::min<u64>(read_in, length), offset - entry->first);
+    return total_read;
 }
 
 std::size_t ConcatenatedVfsFile::Write(const u8* data, std::size_t length, std::size_t offset) {
@@ -140,4 +145,25 @@ bool ConcatenatedVfsFile::Rename(std::string_view name) {
     return false;
 }
 
+std::vector<ConcatenatedVfsFile::ConcatenationEntry> ConcatenatedVfsFile::BuildEntries(
+    const std::multimap<u64, VirtualFile>& files) {
+    std::vector<ConcatenationEntry> entries;
+    entries.reserve(files.size());
+    for (const auto& [offset, file] : files) {
+        // Empty files would share their offset with the next file and can never be read from.
+        if (const auto size = file->GetSize(); size != 0) {
+            entries.push_back({offset, size, file});
+        }
+    }
+    return entries;
+}
+
+std::vector<u64> ConcatenatedVfsFile::GetEntryOffsets(
+    const std::vector<ConcatenationEntry>& entries) {
+    std::vector<u64> offsets(entries.size());
+    std::transform(entries.begin(), entries.end(), offsets.begin(),
+                   [](const ConcatenationEntry& entry) { return entry.offset; });
+    return offsets;
+}
+
 } // namespace FileSys
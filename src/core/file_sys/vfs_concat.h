@@ -7,6 +7,8 @@
 #include <map>
 #include <memory>
 #include <string_view>
+#include <vector>
+#include "core/file_sys/interval_index.h"
 #include "core/file_sys/vfs.h"
 
 namespace FileSys {
@@ -39,8 +41,19 @@ public:
     bool Rename(std::string_view name) override;
 
 private:
-    // Maps starting offset to file -- more efficient.
-    std::multimap<u64, VirtualFile> files;
+    struct ConcatenationEntry {
+        u64 offset;
+        u64 size;
+        VirtualFile file;
+    };
+
+    static std::vector<ConcatenationEntry> BuildEntries(
+        const std::multimap<u64, VirtualFile>& files);
+    static std::vector<u64> GetEntryOffsets(const std::vector<ConcatenationEntry>& entries);
+
+    // Sorted by offset, without any empty files.
+    std::vector<ConcatenationEntry> files;
+    IntervalIndex index;
     std::string name;
 };
 
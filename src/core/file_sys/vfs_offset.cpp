@@ -73,6 +73,13 @@ std::vector<u8> OffsetVfsFile::ReadAllBytes() const {
     return file->ReadBytes(size, offset);
 }
 
+std::span<const u8> OffsetVfsFile::GetSpan(std::size_t r_offset, std::size_t length) const {
+    if (r_offset >= size) {
+        return {};
+    }
+    return file->GetSpan(offset + r_offset, TrimToFit(length, r_offset));
+}
+
 bool OffsetVfsFile::WriteByte(u8 data, std::size_t r_offset) {
     if (r_offset < size)
         return file->WriteByte(data, offset + r_offset);
@@ -92,6 +99,10 @@ std::size_t OffsetVfsFile::GetOffset() const {
     return offset;
 }
 
+VirtualFile OffsetVfsFile::GetBaseFile() const {
+    return file;
+}
+
 std::size_t OffsetVfsFile::TrimToFit(std::size_t r_size, std::size_t r_offset) const {
     return std::clamp(r_size, std::size_t{0}, size - r_offset);
 }
@@ -0,0 +1,251 @@
+// Copyright 2020 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common/thread.h"
+#include "core/file_sys/vfs_read_ahead.h"
+
+namespace FileSys {
+
+namespace {
+constexpr std::size_t CHUNK_SIZE = 0x40000;
+// Bounds the memory held by each file to MAX_CHUNKS * CHUNK_SIZE.
+constexpr std::size_t MAX_CHUNKS = 4;
+// Number of consecutive sequential reads before read-ahead kicks in.
+constexpr u32 SEQUENTIAL_READ_THRESHOLD = 2;
+// Host storage rarely benefits from more parallelism than this, especially spinning disks.
+constexpr std::size_t NUM_WORKERS = 2;
+
+// A small pool of host threads shared by every ReadAheadVfsFile.
+class ReadAheadWorkers {
+public:
+    static ReadAheadWorkers& Instance() {
+        static ReadAheadWorkers instance;
+        return instance;
+    }
+
+    void Push(std::function<void()> job) {
+        {
+            std::lock_guard lock{mutex};
+            jobs.push_back(std::move(job));
+        }
+        job_available.notify_one();
+    }
+
+private:
+    ReadAheadWorkers() {
+        for (std::size_t i = 0; i < NUM_WORKERS; ++i) {
+            threads.emplace_back([this] { WorkerLoop(); });
+        }
+    }
+
+    ~ReadAheadWorkers() {
+        {
+            std::lock_guard lock{mutex};
+            stop = true;
+        }
+        job_available.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    void WorkerLoop() {
+        Common::SetCurrentThreadName("yuzu:ReadAhead");
+
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock lock{mutex};
+                job_available.wait(lock, [this] { return stop || !jobs.empty(); });
+                if (stop) {
+                    return;
+                }
+                job = std::move(jobs.front());
+                jobs.pop_front();
+            }
+            job();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable job_available;
+    std::deque<std::function<void()>> jobs;
+    bool stop = false;
+    std::vector<std::thread> threads;
+};
+} // Anonymous namespace
+
+struct ReadAheadVfsFile::State {
+    struct Chunk {
+        std::size_t offset;
+        std::size_t size;
+        std::vector<u8> data;
+        bool ready = false;
+        // Set once the chunk is evicted, so a worker that has not started on it can skip it.
+        bool cancelled = false;
+    };
+
+    explicit State(VirtualFile base_) : base(std::move(base_)), size(base->GetSize()) {}
+
+    // Runs on a worker thread.
+    void FetchChunk(const std::shared_ptr<Chunk>& chunk) {
+        std::vector<u8> chunk_data;
+        {
+            std::lock_guard lock{mutex};
+            if (!chunk->cancelled) {
+                chunk_data.resize(chunk->size);
+            }
+        }
+
+        if (!chunk_data.empty()) {
+            chunk_data.resize(base->Read(chunk_data.data(), chunk_data.size(), chunk->offset));
+        }
+
+        {
+            std::lock_guard lock{mutex};
+            chunk->data = std::move(chunk_data);
+            chunk->ready = true;
+        }
+        chunk_ready.notify_all();
+    }
+
+    void EvictChunksBefore(std::size_t offset) {
+        while (!chunks.empty() && chunks.front()->offset + chunks.front()->size <= offset) {
+            chunks.front()->cancelled = true;
+            chunks.pop_front();
+        }
+    }
+
+    void EvictAllChunks() {
+        for (const auto& chunk : chunks) {
+            chunk->cancelled = true;
+        }
+        chunks.clear();
+    }
+
+    VirtualFile base;
+    std::size_t size;
+
+    // Guards everything below.
+    std::mutex mutex;
+    std::condition_variable chunk_ready;
+    // Contiguous and in file order.
+    std::deque<std::shared_ptr<Chunk>> chunks;
+    std::size_t next_offset = 0;
+    u32 sequential_reads = 0;
+};
+
+ReadAheadVfsFile::ReadAheadVfsFile(VirtualFile base_)
+    : state(std::make_shared<State>(std::move(base_))) {}
+
+ReadAheadVfsFile::~ReadAheadVfsFile() {
+    std::lock_guard lock{state->mutex};
+    state->EvictAllChunks();
+}
+
+std::string ReadAheadVfsFile::GetName() const {
+    return state->base->GetName();
+}
+
+std::size_t ReadAheadVfsFile::GetSize() const {
+    return state->size;
+}
+
+bool ReadAheadVfsFile::Resize(std::size_t new_size) {
+    return false;
+}
+
+VirtualDir ReadAheadVfsFile::GetContainingDirectory() const {
+    return state->base->GetContainingDirectory();
+}
+
+bool ReadAheadVfsFile::IsWritable() const {
+    return false;
+}
+
+bool ReadAheadVfsFile::IsReadable() const {
+    return true;
+}
+
+std::size_t ReadAheadVfsFile::Read(u8* data, std::size_t length, std::size_t offset) const {
+    if (offset >= state->size) {
+        return 0;
+    }
+    length = std::min(length, state->size - offset);
+
+    std::unique_lock lock{state->mutex};
+    const bool sequential = offset == state->next_offset;
+    state->sequential_reads = sequential ? state->sequential_reads + 1 : 0;
+    state->next_offset = offset + length;
+
+    // Chunks are contiguous, so after dropping the ones behind this read either the first chunk
+    // contains its start or none of the buffered data is useful anymore.
+    state->EvictChunksBefore(offset);
+    if (!state->chunks.empty() && state->chunks.front()->offset > offset) {
+        state->EvictAllChunks();
+    }
+
+    std::size_t total_read = 0;
+    while (total_read != length && !state->chunks.empty()) {
+        const auto chunk = state->chunks.front();
+        state->chunk_ready.wait(lock, [&chunk] { return chunk->ready; });
+
+        const auto chunk_offset = offset + total_read - chunk->offset;
+        if (chunk->cancelled || chunk_offset >= chunk->data.size()) {
+            break;
+        }
+
+        const auto to_copy = std::min(length - total_read, chunk->data.size() - chunk_offset);
+        std::memcpy(data + total_read, chunk->data.data() + chunk_offset, to_copy);
+        total_read += to_copy;
+        state->EvictChunksBefore(offset + total_read);
+    }
+
+    if (total_read != length) {
+        state->EvictAllChunks();
+        lock.unlock();
+        total_read +=
+            state->base->Read(data + total_read, length - total_read, offset + total_read);
+        lock.lock();
+    }
+
+    if (state->sequential_reads < SEQUENTIAL_READ_THRESHOLD) {
+        return total_read;
+    }
+
+    auto next_chunk = state->chunks.empty()
+                          ? state->next_offset
+                          : state->chunks.back()->offset + state->chunks.back()->size;
+    while (state->chunks.size() < MAX_CHUNKS && next_chunk < state->size) {
+        auto chunk = std::make_shared<State::Chunk>();
+        chunk->offset = next_chunk;
+        chunk->size = std::min(CHUNK_SIZE, state->size - next_chunk);
+        next_chunk += chunk->size;
+
+        state->chunks.push_back(chunk);
+        ReadAheadWorkers::Instance().Push(
+            [state = state, chunk = std::move(chunk)] { state->FetchChunk(chunk); });
+    }
+
+    return total_read;
+}
+
+std::size_t ReadAheadVfsFile::Write(const u8* data, std::size_t length, std::size_t offset) {
+    return 0;
+}
+
+bool ReadAheadVfsFile::Rename(std::string_view name) {
+    return state->base->Rename(name);
+}
+
+} // namespace FileSys
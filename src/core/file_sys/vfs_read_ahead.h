@@ -0,0 +1,45 @@
+// Copyright 2020 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include <string_view>
+
+#include "core/file_sys/vfs.h"
+
+namespace FileSys {
+
+// Sits on top of a read-only VfsFile and watches for sequential access. Once several reads in a
+// row have each started where the previous one ended, the next few chunks of the file are read on
+// a host worker thread ahead of time and kept in a small bounded buffer, so that a guest streaming
+// through the file finds its next read already done, including any decryption performed by the
+// layers below.
+//
+// The base is read from the worker threads and the calling thread at once, so it must be safe to
+// read concurrently. It must also not change while wrapped, so files on writable host storage
+// (save data, SD card) must not be wrapped.
+class ReadAheadVfsFile : public VfsFile {
+public:
+    explicit ReadAheadVfsFile(VirtualFile base);
+    ~ReadAheadVfsFile() override;
+
+    std::string GetName() const override;
+    std::size_t GetSize() const override;
+    bool Resize(std::size_t new_size) override;
+    VirtualDir GetContainingDirectory() const override;
+    bool IsWritable() const override;
+    bool IsReadable() const override;
+    std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
+    std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override;
+    bool Rename(std::string_view name) override;
+
+private:
+    struct State;
+
+    // Shared with pending worker jobs, which may outlive this file.
+    std::shared_ptr<State> state;
+};
+
+} // namespace FileSys
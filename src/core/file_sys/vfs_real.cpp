@@ -3,13 +3,19 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <array>
 #include <cstddef>
+#include <cstring>
+#include <ctime>
+#include <functional>
 #include <iterator>
+#include <mutex>
 #include <utility>
 #include "common/assert.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
+#include "common/string_util.h"
 #include "core/file_sys/vfs_real.h"
 
 namespace FileSys {
@@ -43,6 +49,34 @@ static std::string ModeFlagsToString(Mode mode) {
     return mode_str;
 }
 
+constexpr std::size_t MAX_CACHED_LISTINGS = 1024;
+
+// Every file opened at the same path shares one IOFile, whose position is moved by each access.
+// Guards a seek and the access following it against other threads using the same IOFile.
+static std::mutex& GetBackingMutex(const FS::IOFile* backing) {
+    static std::array<std::mutex, 16> mutexes;
+    return mutexes[std::hash<const FS::IOFile*>{}(backing) % mutexes.size()];
+}
+
+// Game content files are large, never modified while they are open for reading and read at random
+// offsets throughout emulation, which makes them worth mapping instead of seeking and reading.
+// Files in the user directory, such as installed content, may be truncated by another handle
+// while mapped, which would fault on access, so they are always read through their IOFile.
+static bool ShouldMapFile(const std::string& path, Mode perms) {
+    if (perms != Mode::Read) {
+        return false;
+    }
+
+    const auto user_dir = FS::SanitizePath(FS::GetUserPath(FS::UserPath::UserDir),
+                                           FS::DirectorySeparator::PlatformDefault);
+    if (path.rfind(user_dir, 0) == 0) {
+        return false;
+    }
+
+    const auto extension = Common::ToLower(std::string(FS::GetExtensionFromFilename(path)));
+    return extension == "nsp" || extension == "xci" || extension == "nca";
+}
+
 RealVfsFilesystem::RealVfsFilesystem() : VfsFilesystem(nullptr) {}
 RealVfsFilesystem::~RealVfsFilesystem() = default;
 
@@ -72,24 +106,126 @@ VfsEntryType RealVfsFilesystem::GetEntryType(std::string_view path_) const {
 
 VirtualFile RealVfsFilesystem::OpenFile(std::string_view path_, Mode perms) {
     const auto path = FS::SanitizePath(path_, FS::DirectorySeparator::PlatformDefault);
+    auto [backing, mapping] = OpenBacking(path, perms, true);
 
-    if (const auto weak_iter = cache.find(path); weak_iter != cache.cend()) {
-        const auto& weak = weak_iter->second;
+    // Cannot use make_shared as RealVfsFile constructor is private
+    return std::shared_ptr<RealVfsFile>(
+        new RealVfsFile(*this, std::move(backing), std::move(mapping), path, perms));
+}
+
+std::pair<std::shared_ptr<FS::IOFile>, std::shared_ptr<FS::MappedFile>>
+RealVfsFilesystem::OpenBacking(const std::string& path, Mode perms, bool create) {
+    std::lock_guard lock{mutex};
 
-        if (!weak.expired()) {
-            return std::shared_ptr<RealVfsFile>(new RealVfsFile(*this, weak.lock(), path, perms));
+    std::shared_ptr<FS::MappedFile> mapping;
+    if (ShouldMapFile(path, perms)) {
+        mapping = OpenMapping(path);
+    } else if (True(perms & Mode::WriteAppend)) {
+        // The file may change from now on, so later readers map it anew.
+        CloseMapping(path);
+    }
+
+    if (const auto weak_iter = cache.find(path); weak_iter != cache.cend()) {
+        if (auto backing = weak_iter->second.lock()) {
+            return {std::move(backing), std::move(mapping)};
         }
     }
 
-    if (!FS::Exists(path) && True(perms & Mode::WriteAppend)) {
+    if (create && !FS::Exists(path) && True(perms & Mode::WriteAppend)) {
         FS::CreateEmptyFile(path);
+        InvalidateListingsImpl(path);
     }
 
     auto backing = std::make_shared<FS::IOFile>(path, ModeFlagsToString(perms).c_str());
     cache.insert_or_assign(path, backing);
+    return {std::move(backing), std::move(mapping)};
+}
 
-    // Cannot use make_shared as RealVfsFile constructor is private
-    return std::shared_ptr<RealVfsFile>(new RealVfsFile(*this, backing, path, perms));
+std::size_t RealVfsFilesystem::GetFileSize(const std::string& path) {
+    std::shared_ptr<FS::IOFile> backing;
+    {
+        std::lock_guard lock{mutex};
+        if (const auto weak_iter = cache.find(path); weak_iter != cache.cend()) {
+            backing = weak_iter->second.lock();
+        }
+    }
+
+    // A file that is open elsewhere may still have writes buffered.
+    if (backing != nullptr) {
+        return backing->GetSize();
+    }
+    return FS::GetSize(path);
+}
+
+std::shared_ptr<const RealVfsFilesystem::DirectoryListing> RealVfsFilesystem::GetListing(
+    const std::string& path) {
+    if (!FS::Exists(path)) {
+        return std::make_shared<const DirectoryListing>();
+    }
+
+    const auto last_write_time = FS::GetLastWriteTime(path);
+    u64 generation;
+    {
+        std::lock_guard lock{mutex};
+        // A listing taken within the second the directory was last modified in could have missed
+        // later changes made in that same second, so it is not trusted.
+        if (const auto iter = listings.find(path); iter != listings.cend()) {
+            const auto& cached = iter->second;
+            if (cached->last_write_time == last_write_time && last_write_time < cached->listed_at) {
+                return cached;
+            }
+        }
+        generation = listing_generation;
+    }
+
+    auto listing = std::make_shared<DirectoryListing>();
+    listing->last_write_time = last_write_time;
+    listing->listed_at = static_cast<s64>(std::time(nullptr));
+    FS::ForeachDirectoryEntry(
+        nullptr, path,
+        [&listing](u64* entries_out, const std::string& directory, const std::string& filename) {
+            const std::string full_path = directory + DIR_SEP + filename;
+            listing->entries.emplace(filename, FS::IsDirectory(full_path) ? VfsEntryType::Directory
+                                                                          : VfsEntryType::File);
+            return true;
+        });
+
+    std::lock_guard lock{mutex};
+    // Changes made through this filesystem while listing may not be in the listing.
+    if (generation == listing_generation) {
+        if (listings.size() >= MAX_CACHED_LISTINGS) {
+            listings.clear();
+        }
+        listings.insert_or_assign(path, listing);
+    }
+    return listing;
+}
+
+void RealVfsFilesystem::InvalidateListings(const std::string& path) {
+    std::lock_guard lock{mutex};
+    InvalidateListingsImpl(path);
+}
+
+// Drops the listings of the directories leading up to path, which may have been created along
+// with it, and of path itself and anything below it.
+void RealVfsFilesystem::InvalidateListingsImpl(std::string_view path) {
+    path = FS::RemoveTrailingSlash(path);
+    const auto is_separator = [](char c) { return c == '/' || c == '\\'; };
+
+    for (auto iter = listings.begin(); iter != listings.end();) {
+        const std::string_view dir = iter->first;
+        const bool is_parent = path.size() > dir.size() && path.compare(0, dir.size(), dir) == 0 &&
+                               is_separator(path[dir.size()]);
+        const bool is_below = dir.compare(0, path.size(), path) == 0 &&
+                              (dir.size() == path.size() || is_separator(dir[path.size()]));
+        if (is_parent || is_below) {
+            iter = listings.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+
+    ++listing_generation;
 }
 
 VirtualFile RealVfsFilesystem::CreateFile(std::string_view path_, Mode perms) {
@@ -100,6 +236,7 @@ VirtualFile RealVfsFilesystem::CreateFile(std::string_view path_, Mode perms) {
         if (!FS::CreateEmptyFile(path)) {
             return nullptr;
         }
+        InvalidateListings(path);
     }
     return OpenFile(path, perms);
 }
@@ -112,18 +249,25 @@ VirtualFile RealVfsFilesystem::CopyFile(std::string_view old_path_, std::string_
         !FS::Copy(old_path, new_path)) {
         return nullptr;
     }
+    InvalidateListings(new_path);
     return OpenFile(new_path, Mode::ReadWrite);
 }
 
 VirtualFile RealVfsFilesystem::MoveFile(std::string_view old_path_, std::string_view new_path_) {
     const auto old_path = FS::SanitizePath(old_path_, FS::DirectorySeparator::PlatformDefault);
     const auto new_path = FS::SanitizePath(new_path_, FS::DirectorySeparator::PlatformDefault);
-    const auto cached_file_iter = cache.find(old_path);
-
-    if (cached_file_iter != cache.cend()) {
-        auto file = cached_file_iter->second.lock();
+    {
+        std::lock_guard lock{mutex};
+        const auto cached_file_iter = cache.find(old_path);
+        CloseMapping(old_path);
+
+        // Files handed out by directory listings are only opened once they are used.
+        std::shared_ptr<FS::IOFile> file;
+        if (cached_file_iter != cache.cend()) {
+            file = cached_file_iter->second.lock();
+        }
 
-        if (!cached_file_iter->second.expired()) {
+        if (file != nullptr) {
             file->Close();
         }
 
@@ -132,12 +276,13 @@ VirtualFile RealVfsFilesystem::MoveFile(std::string_view old_path_, std::string_
             return nullptr;
         }
 
+        InvalidateListingsImpl(old_path);
+        InvalidateListingsImpl(new_path);
         cache.erase(old_path);
-        file->Open(new_path, "r+b");
-        cache.insert_or_assign(new_path, std::move(file));
-    } else {
-        UNREACHABLE();
-        return nullptr;
+        if (file != nullptr) {
+            file->Open(new_path, "r+b");
+            cache.insert_or_assign(new_path, std::move(file));
+        }
     }
 
     return OpenFile(new_path, Mode::ReadWrite);
@@ -145,7 +290,9 @@ VirtualFile RealVfsFilesystem::MoveFile(std::string_view old_path_, std::string_
 
 bool RealVfsFilesystem::DeleteFile(std::string_view path_) {
     const auto path = FS::SanitizePath(path_, FS::DirectorySeparator::PlatformDefault);
+    std::lock_guard lock{mutex};
     const auto cached_iter = cache.find(path);
+    CloseMapping(path);
 
     if (cached_iter != cache.cend()) {
         if (!cached_iter->second.expired()) {
@@ -154,6 +301,7 @@ bool RealVfsFilesystem::DeleteFile(std::string_view path_) {
         cache.erase(path);
     }
 
+    InvalidateListingsImpl(path);
     return FS::Delete(path);
 }
 
@@ -171,6 +319,7 @@ VirtualDir RealVfsFilesystem::CreateDirectory(std::string_view path_, Mode perms
         if (!FS::CreateDir(path)) {
             return nullptr;
         }
+        InvalidateListings(path);
     }
     // Cannot use make_shared as RealVfsDirectory constructor is private
     return std::shared_ptr<RealVfsDirectory>(new RealVfsDirectory(*this, path, perms));
@@ -184,6 +333,7 @@ VirtualDir RealVfsFilesystem::CopyDirectory(std::string_view old_path_,
         return nullptr;
     }
     FS::CopyDir(old_path, new_path);
+    InvalidateListings(new_path);
     return OpenDirectory(new_path, Mode::ReadWrite);
 }
 
@@ -191,12 +341,16 @@ VirtualDir RealVfsFilesystem::MoveDirectory(std::string_view old_path_,
                                             std::string_view new_path_) {
     const auto old_path = FS::SanitizePath(old_path_, FS::DirectorySeparator::PlatformDefault);
     const auto new_path = FS::SanitizePath(new_path_, FS::DirectorySeparator::PlatformDefault);
+    std::lock_guard lock{mutex};
+    CloseMappingsInDirectory(old_path);
 
     if (!FS::Exists(old_path) || FS::Exists(new_path) || FS::IsDirectory(old_path) ||
         !FS::Rename(old_path, new_path)) {
         return nullptr;
     }
 
+    InvalidateListingsImpl(old_path);
+    InvalidateListingsImpl(new_path);
     for (auto& kv : cache) {
         // If the path in the cache doesn't start with old_path, then bail on this file.
         if (kv.first.rfind(old_path, 0) != 0) {
@@ -224,6 +378,8 @@ VirtualDir RealVfsFilesystem::MoveDirectory(std::string_view old_path_,
 
 bool RealVfsFilesystem::DeleteDirectory(std::string_view path_) {
     const auto path = FS::SanitizePath(path_, FS::DirectorySeparator::PlatformDefault);
+    std::lock_guard lock{mutex};
+    CloseMappingsInDirectory(path);
 
     for (auto& kv : cache) {
         // If the path in the cache doesn't start with path, then bail on this file.
@@ -239,28 +395,83 @@ bool RealVfsFilesystem::DeleteDirectory(std::string_view path_) {
         cache.erase(kv.first);
     }
 
+    InvalidateListingsImpl(path);
     return FS::DeleteDirRecursively(path);
 }
 
+std::shared_ptr<FS::MappedFile> RealVfsFilesystem::OpenMapping(const std::string& path) {
+    if (const auto iter = mappings.find(path); iter != mappings.cend()) {
+        if (auto mapping = iter->second.lock()) {
+            return mapping;
+        }
+    }
+
+    auto mapping = std::make_shared<FS::MappedFile>(path);
+    if (!mapping->IsOpen()) {
+        mappings.erase(path);
+        return nullptr;
+    }
+
+    mappings.insert_or_assign(path, mapping);
+    return mapping;
+}
+
+// Stops handing out the mapping of a file that is moved, deleted or written. Files still holding
+// the mapping may be reading from it, so it is only unmapped once the last of them is destroyed.
+void RealVfsFilesystem::CloseMapping(const std::string& path) {
+    mappings.erase(path);
+}
+
+void RealVfsFilesystem::CloseMappingsInDirectory(const std::string& path) {
+    for (auto iter = mappings.begin(); iter != mappings.end();) {
+        if (iter->first.rfind(path, 0) == 0) {
+            iter = mappings.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
 RealVfsFile::RealVfsFile(RealVfsFilesystem& base_, std::shared_ptr<FS::IOFile> backing_,
-                         const std::string& path_, Mode perms_)
-    : base(base_), backing(std::move(backing_)), path(path_), parent_path(FS::GetParentPath(path_)),
+                         std::shared_ptr<FS::MappedFile> mapping_, const std::string& path_,
+                         Mode perms_)
+    : base(base_), backing(std::move(backing_)), mapping(std::move(mapping_)), path(path_),
+      parent_path(FS::GetParentPath(path_)),
       path_components(FS::SplitPathComponents(path_)),
       parent_components(FS::SliceVector(path_components, 0, path_components.size() - 1)),
-      perms(perms_) {}
+      perms(perms_), opened(true) {}
+
+RealVfsFile::RealVfsFile(RealVfsFilesystem& base_, const std::string& path_, Mode perms_)
+    : RealVfsFile(base_, nullptr, nullptr, path_, perms_) {
+    opened = false;
+}
 
 RealVfsFile::~RealVfsFile() = default;
 
+const std::shared_ptr<FS::IOFile>& RealVfsFile::GetBacking() const {
+    std::call_once(open_flag, [this] {
+        if (backing == nullptr) {
+            std::tie(backing, mapping) = base.OpenBacking(path, perms, false);
+            opened = true;
+        }
+    });
+    return backing;
+}
+
 std::string RealVfsFile::GetName() const {
     return path_components.back();
 }
 
 std::size_t RealVfsFile::GetSize() const {
-    return backing->GetSize();
+    // Listed files report their size without being opened.
+    if (!opened) {
+        return base.GetFileSize(path);
+    }
+    return GetBacking()->GetSize();
 }
 
 bool RealVfsFile::Resize(std::size_t new_size) {
-    return backing->Resize(new_size);
+    return GetBacking()->Resize(new_size);
 }
 
 VirtualDir RealVfsFile::GetContainingDirectory() const {
@@ -276,17 +487,34 @@ bool RealVfsFile::IsReadable() const {
 }
 
 std::size_t RealVfsFile::Read(u8* data, std::size_t length, std::size_t offset) const {
-    if (!backing->Seek(static_cast<s64>(offset), SEEK_SET)) {
+    if (const auto span = GetSpan(offset, length); span.size() == length) {
+        std::memcpy(data, span.data(), length);
+        return length;
+    }
+
+    const auto& file = GetBacking();
+    std::lock_guard lock{GetBackingMutex(file.get())};
+    if (!file->Seek(static_cast<s64>(offset), SEEK_SET)) {
         return 0;
     }
-    return backing->ReadBytes(data, length);
+    return file->ReadBytes(data, length);
+}
+
+std::span<const u8> RealVfsFile::GetSpan(std::size_t offset, std::size_t length) const {
+    GetBacking();
+    if (mapping == nullptr || offset >= mapping->GetSize()) {
+        return {};
+    }
+    return {mapping->GetData() + offset, std::min(length, mapping->GetSize() - offset)};
 }
 
 std::size_t RealVfsFile::Write(const u8* data, std::size_t length, std::size_t offset) {
-    if (!backing->Seek(static_cast<s64>(offset), SEEK_SET)) {
+    const auto& file = GetBacking();
+    std::lock_guard lock{GetBackingMutex(file.get())};
+    if (!file->Seek(static_cast<s64>(offset), SEEK_SET)) {
         return 0;
     }
-    return backing->WriteBytes(data, length);
+    return file->WriteBytes(data, length);
 }
 
 bool RealVfsFile::Rename(std::string_view name) {
@@ -294,7 +522,7 @@ bool RealVfsFile::Rename(std::string_view name) {
 }
 
 bool RealVfsFile::Close() {
-    return backing->Close();
+    return GetBacking()->Close();
 }
 
 // TODO(DarkLordZach): MSVC would not let me combine the following two functions using 'if
@@ -306,16 +534,15 @@ std::vector<VirtualFile> RealVfsDirectory::IterateEntries<RealVfsFile, VfsFile>(
         return {};
     }
 
+    const auto listing = base.GetListing(path);
     std::vector<VirtualFile> out;
-    FS::ForeachDirectoryEntry(
-        nullptr, path,
-        [&out, this](u64* entries_out, const std::string& directory, const std::string& filename) {
-            const std::string full_path = directory + DIR_SEP + filename;
-            if (!FS::IsDirectory(full_path)) {
-                out.emplace_back(base.OpenFile(full_path, perms));
-            }
-            return true;
-        });
+    for (const auto& [name, type] : listing->entries) {
+        if (type == VfsEntryType::File) {
+            // Cannot use make_shared as RealVfsFile constructor is private
+            out.emplace_back(
+                std::shared_ptr<RealVfsFile>(new RealVfsFile(base, path + DIR_SEP + name, perms)));
+        }
+    }
 
     return out;
 }
@@ -326,16 +553,13 @@ std::vector<VirtualDir> RealVfsDirectory::IterateEntries<RealVfsDirectory, VfsDi
         return {};
     }
 
+    const auto listing = base.GetListing(path);
     std::vector<VirtualDir> out;
-    FS::ForeachDirectoryEntry(
-        nullptr, path,
-        [&out, this](u64* entries_out, const std::string& directory, const std::string& filename) {
-            const std::string full_path = directory + DIR_SEP + filename;
-            if (FS::IsDirectory(full_path)) {
-                out.emplace_back(base.OpenDirectory(full_path, perms));
-            }
-            return true;
-        });
+    for (const auto& [name, type] : listing->entries) {
+        if (type == VfsEntryType::Directory) {
+            out.emplace_back(base.OpenDirectory(path + DIR_SEP + name, perms));
+        }
+    }
 
     return out;
 }
@@ -347,6 +571,7 @@ RealVfsDirectory::RealVfsDirectory(RealVfsFilesystem& base_, const std::string&
       perms(perms_) {
     if (!FS::Exists(path) && True(perms & Mode::WriteAppend)) {
         FS::CreateDir(path);
+        base.InvalidateListings(path);
     }
 }
 
@@ -455,17 +680,7 @@ std::map<std::string, VfsEntryType, std::less<>> RealVfsDirectory::GetEntries()
         return {};
     }
 
-    std::map<std::string, VfsEntryType, std::less<>> out;
-    FS::ForeachDirectoryEntry(
-        nullptr, path,
-        [&out](u64* entries_out, const std::string& directory, const std::string& filename) {
-            const std::string full_path = directory + DIR_SEP + filename;
-            out.emplace(filename,
-                        FS::IsDirectory(full_path) ? VfsEntryType::Directory : VfsEntryType::File);
-            return true;
-        });
-
-    return out;
+    return base.GetListing(path)->entries;
 }
 
 } // namespace FileSys
@@ -4,18 +4,26 @@
 
 #pragma once
 
+#include <atomic>
+#include <map>
+#include <mutex>
 #include <string_view>
+#include <utility>
 #include <boost/container/flat_map.hpp>
 #include "core/file_sys/mode.h"
 #include "core/file_sys/vfs.h"
 
 namespace Common::FS {
 class IOFile;
+class MappedFile;
 }
 
 namespace FileSys {
 
 class RealVfsFilesystem : public VfsFilesystem {
+    friend class RealVfsDirectory;
+    friend class RealVfsFile;
+
 public:
     RealVfsFilesystem();
     ~RealVfsFilesystem() override;
@@ -36,7 +44,34 @@ public:
     bool DeleteDirectory(std::string_view path) override;
 
 private:
+    // The entries of a host directory, as of when it was last modified.
+    struct DirectoryListing {
+        s64 last_write_time;
+        s64 listed_at;
+        std::map<std::string, VfsEntryType, std::less<>> entries;
+    };
+
+    std::pair<std::shared_ptr<Common::FS::IOFile>, std::shared_ptr<Common::FS::MappedFile>>
+    OpenBacking(const std::string& path, Mode perms, bool create);
+    std::size_t GetFileSize(const std::string& path);
+    std::shared_ptr<const DirectoryListing> GetListing(const std::string& path);
+    void InvalidateListings(const std::string& path);
+
+    // These must be called with mutex held.
+    std::shared_ptr<Common::FS::MappedFile> OpenMapping(const std::string& path);
+    void CloseMapping(const std::string& path);
+    void CloseMappingsInDirectory(const std::string& path);
+    void InvalidateListingsImpl(std::string_view path);
+
+    // Guards cache, mappings and listings, as files may be opened from several threads at once.
+    std::mutex mutex;
     boost::container::flat_map<std::string, std::weak_ptr<Common::FS::IOFile>> cache;
+    // Read-only game files are additionally mapped into memory and share one mapping per path.
+    boost::container::flat_map<std::string, std::weak_ptr<Common::FS::MappedFile>> mappings;
+    // Listings are reused while the modification time of the directory stays the same, and
+    // dropped when the directory is changed through this filesystem.
+    boost::container::flat_map<std::string, std::shared_ptr<const DirectoryListing>> listings;
+    u64 listing_generation = 0;
 };
 
 // An implmentation of VfsFile that represents a file on the user's computer.
@@ -54,22 +89,35 @@ public:
     bool IsWritable() const override;
     bool IsReadable() const override;
     std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
+    std::span<const u8> GetSpan(std::size_t offset, std::size_t length) const override;
     std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override;
     bool Rename(std::string_view name) override;
 
 private:
     RealVfsFile(RealVfsFilesystem& base, std::shared_ptr<Common::FS::IOFile> backing,
-                const std::string& path, Mode perms = Mode::Read);
+                std::shared_ptr<Common::FS::MappedFile> mapping, const std::string& path,
+                Mode perms = Mode::Read);
+
+    // Files listed from a directory are only opened once their contents are first accessed.
+    RealVfsFile(RealVfsFilesystem& base, const std::string& path, Mode perms);
+
+    const std::shared_ptr<Common::FS::IOFile>& GetBacking() const;
 
     bool Close();
 
     RealVfsFilesystem& base;
-    std::shared_ptr<Common::FS::IOFile> backing;
+    mutable std::once_flag open_flag;
+    mutable std::shared_ptr<Common::FS::IOFile> backing;
+    // Only present for read-only game files. Reads are served from it whenever it covers the
+    // requested range, and from backing otherwise.
+    mutable std::shared_ptr<Common::FS::MappedFile> mapping;
     std::string path;
     std::string parent_path;
     std::vector<std::string> path_components;
     std::vector<std::string> parent_components;
     Mode perms;
+    // Set once backing has been opened.
+    mutable std::atomic_bool opened;
 };
 
 // An implementation of VfsDirectory that represents a directory on the user's computer.
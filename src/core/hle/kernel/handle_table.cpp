@@ -2,7 +2,11 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <iterator>
+#include <mutex>
 #include <utility>
+#include <vector>
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "core/core.h"
@@ -24,6 +28,30 @@ constexpr u16 GetGeneration(Handle handle) {
 }
 } // Anonymous namespace
 
+HandleTable::BorrowGuard::BorrowGuard(const HandleTable& table_) : table{table_} {
+    const u32 parity = table.epoch.load(std::memory_order_relaxed) & 1;
+    const std::size_t index = table.kernel.GetCurrentHostThreadID() % NUM_READER_COUNTS;
+    reader_count = &table.reader_counts[index].counts[parity];
+    reader_count->fetch_add(1, std::memory_order_relaxed);
+
+    // Pairs with the fence in ReclaimRetired(): either the reclaimer sees this reader, or this
+    // reader sees the slots of the objects it retired as empty.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+HandleTable::BorrowGuard::~BorrowGuard() {
+    if (reader_count->fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    // Pairs with the fence in ReclaimRetired(): either a concurrent reclaimer sees this reader
+    // gone, or this reader sees the objects it left retired and releases them itself.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (table.has_retired.load(std::memory_order_relaxed)) {
+        table.ReclaimRetired();
+    }
+}
+
 HandleTable::HandleTable(KernelCore& kernel) : kernel{kernel} {
     Clear();
 }
@@ -50,6 +78,7 @@ ResultCode HandleTable::SetSize(s32 handle_table_size) {
 ResultVal<Handle> HandleTable::Create(std::shared_ptr<Object> obj) {
     DEBUG_ASSERT(obj != nullptr);
 
+    std::lock_guard guard{lock};
     const u16 slot = next_free_slot;
     if (slot >= table_size) {
         LOG_ERROR(Kernel, "Unable to allocate Handle, too many slots in use.");
@@ -65,8 +94,12 @@ ResultVal<Handle> HandleTable::Create(std::shared_ptr<Object> obj) {
         next_generation = 1;
     }
 
+    BeginWrite();
     generations[slot] = generation;
+    slot_objects[slot].store(obj.get(), std::memory_order_relaxed);
+    slot_generations[slot].store(generation, std::memory_order_relaxed);
     objects[slot] = std::move(obj);
+    EndWrite();
 
     Handle handle = generation | (slot << 15);
     return MakeResult<Handle>(handle);
@@ -82,25 +115,35 @@ ResultVal<Handle> HandleTable::Duplicate(Handle handle) {
 }
 
 ResultCode HandleTable::Close(Handle handle) {
-    if (!IsValid(handle)) {
+    bool closed = false;
+    {
+        std::lock_guard guard{lock};
+        if (IsValid(handle)) {
+            const u16 slot = GetSlot(handle);
+
+            BeginWrite();
+            retired_current.push_back(std::move(objects[slot]));
+            has_retired.store(true, std::memory_order_relaxed);
+            slot_objects[slot].store(nullptr, std::memory_order_relaxed);
+            slot_generations[slot].store(0, std::memory_order_relaxed);
+            generations[slot] = next_free_slot;
+            next_free_slot = slot;
+            EndWrite();
+            closed = true;
+        }
+    }
+
+    if (!closed) {
         LOG_ERROR(Kernel, "Handle is not valid! handle={:08X}", handle);
         return ERR_INVALID_HANDLE;
     }
 
-    const u16 slot = GetSlot(handle);
-
-    objects[slot] = nullptr;
-
-    generations[slot] = next_free_slot;
-    next_free_slot = slot;
+    ReclaimRetired();
     return RESULT_SUCCESS;
 }
 
 bool HandleTable::IsValid(Handle handle) const {
-    const std::size_t slot = GetSlot(handle);
-    const u16 generation = GetGeneration(handle);
-
-    return slot < table_size && objects[slot] != nullptr && generations[slot] == generation;
+    return LookupSlot(handle) != nullptr;
 }
 
 std::shared_ptr<Object> HandleTable::GetGeneric(Handle handle) const {
@@ -110,18 +153,108 @@ std::shared_ptr<Object> HandleTable::GetGeneric(Handle handle) const {
         return SharedFrom(kernel.CurrentProcess());
     }
 
-    if (!IsValid(handle)) {
-        return nullptr;
+    // The object is at least retired until the guard is released, so its owners cannot drop to
+    // zero while the reference is acquired.
+    const BorrowGuard guard{*this};
+    return SharedFrom(LookupSlot(handle));
+}
+
+Object* HandleTable::GetGenericPtr([[maybe_unused]] const BorrowGuard& guard,
+                                   Handle handle) const {
+    if (handle == CurrentThread) {
+        return kernel.CurrentScheduler().GetCurrentThread();
+    } else if (handle == CurrentProcess) {
+        return kernel.CurrentProcess();
     }
-    return objects[GetSlot(handle)];
+
+    return LookupSlot(handle);
 }
 
 void HandleTable::Clear() {
-    for (u16 i = 0; i < table_size; ++i) {
-        generations[i] = static_cast<u16>(i + 1);
-        objects[i] = nullptr;
+    {
+        std::lock_guard guard{lock};
+        BeginWrite();
+        for (u16 i = 0; i < MAX_COUNT; ++i) {
+            generations[i] = static_cast<u16>(i + 1);
+            if (objects[i] != nullptr) {
+                retired_current.push_back(std::move(objects[i]));
+                has_retired.store(true, std::memory_order_relaxed);
+            }
+            slot_objects[i].store(nullptr, std::memory_order_relaxed);
+            slot_generations[i].store(0, std::memory_order_relaxed);
+        }
+        next_free_slot = 0;
+        EndWrite();
+    }
+    ReclaimRetired();
+}
+
+Object* HandleTable::LookupSlot(Handle handle) const {
+    const std::size_t slot = GetSlot(handle);
+    const u16 generation = GetGeneration(handle);
+    if (slot >= table_size || generation == 0) {
+        return nullptr;
+    }
+
+    while (true) {
+        const u32 begin = sequence.load(std::memory_order_acquire);
+        if ((begin & 1) != 0) {
+            continue;
+        }
+
+        const u16 slot_generation = slot_generations[slot].load(std::memory_order_relaxed);
+        Object* const object = slot_objects[slot].load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == begin) {
+            return slot_generation == generation ? object : nullptr;
+        }
+    }
+}
+
+void HandleTable::BeginWrite() {
+    sequence.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void HandleTable::EndWrite() {
+    sequence.fetch_add(1, std::memory_order_release);
+}
+
+void HandleTable::ReclaimRetired() const {
+    std::vector<std::shared_ptr<Object>> released;
+    {
+        std::lock_guard guard{lock};
+
+        // Objects retired in the current epoch need the epoch advanced twice, so try both steps.
+        for (int step = 0; step < 2; ++step) {
+            if (retired_previous.empty() && retired_current.empty()) {
+                break;
+            }
+
+            // Readers of the previous epoch entered before the previously retired objects were
+            // removed from their slots, and may still be using them.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const u32 previous_parity = (epoch.load(std::memory_order_relaxed) + 1) & 1;
+            const bool has_readers =
+                std::any_of(reader_counts.begin(), reader_counts.end(), [&](const auto& counts) {
+                    return counts.counts[previous_parity].load(std::memory_order_acquire) != 0;
+                });
+            if (has_readers) {
+                break;
+            }
+
+            std::move(retired_previous.begin(), retired_previous.end(),
+                      std::back_inserter(released));
+            retired_previous = std::move(retired_current);
+            retired_current.clear();
+            epoch.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        has_retired.store(!retired_previous.empty() || !retired_current.empty(),
+                          std::memory_order_relaxed);
     }
-    next_free_slot = 0;
+    // The last references may be dropped here, so destroy the objects outside of the lock.
 }
 
 } // namespace Kernel
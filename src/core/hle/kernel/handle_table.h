@@ -5,10 +5,13 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <cstddef>
 #include <memory>
+#include <vector>
 
 #include "common/common_types.h"
+#include "common/spin_lock.h"
 #include "core/hle/kernel/object.h"
 #include "core/hle/result.h"
 
@@ -44,12 +47,38 @@ enum KernelHandle : Handle {
  * is destroyed, it is again pushed onto the list to be re-used by the next allocation. It is
  * likely that this allocation strategy differs from the one used in CTR-OS, but this hasn't been
  * verified and isn't likely to cause any problems.
+ *
+ * Lookups are lock-free: every slot mirrors its object pointer and generation in atomics, and a
+ * sequence counter (seqlock) bumped around each mutation lets readers detect and retry torn
+ * reads. Mutations are serialized by a spin lock.
+ *
+ * Objects whose handles are closed are not released right away, since a lookup on another core
+ * may still be using them. Lookups run inside a BorrowGuard, which counts the reader against the
+ * current reclamation epoch. Closed objects are retired into the current epoch, and are only
+ * released once the epoch was advanced and every reader that entered before that has left. The
+ * last reader to leave tries to release them again, so they are never kept alive for longer than
+ * the lookups using them.
  */
 class HandleTable final : NonCopyable {
 public:
     /// This is the maximum limit of handles allowed per process in Horizon
     static constexpr std::size_t MAX_COUNT = 1024;
 
+    /**
+     * Keeps the objects looked up while it is in scope from being released, even if their
+     * handles are closed concurrently. Should only be held for a short time, as closed objects
+     * pile up until it is released.
+     */
+    class BorrowGuard final : NonCopyable {
+    public:
+        explicit BorrowGuard(const HandleTable& table);
+        ~BorrowGuard();
+
+    private:
+        const HandleTable& table;
+        std::atomic<u32>* reader_count;
+    };
+
     explicit HandleTable(KernelCore& kernel);
     ~HandleTable();
 
@@ -108,13 +137,82 @@ public:
         return DynamicObjectCast<T>(GetGeneric(handle));
     }
 
+    /**
+     * Looks up a handle without acquiring a reference to the object.
+     * The returned pointer is only valid while `guard` is in scope. Use GetGeneric() if the object
+     * needs to be retained.
+     * @return Pointer to the looked-up object, or `nullptr` if the handle is not valid.
+     */
+    Object* GetGenericPtr(const BorrowGuard& guard, Handle handle) const;
+
+    /**
+     * Looks up a handle while verifying its type, without acquiring a reference to the object.
+     * @see GetGenericPtr
+     * @return Pointer to the looked-up object, or `nullptr` if the handle is not valid or its
+     *         type differs from the requested one.
+     */
+    template <class T>
+    T* GetPtr(const BorrowGuard& guard, Handle handle) const {
+        return DynamicObjectCast<T>(GetGenericPtr(guard, handle));
+    }
+
     /// Closes all handles held in this table.
     void Clear();
 
 private:
+    /// Looks up the borrowed object of a non-pseudo handle, retrying while a writer is active.
+    Object* LookupSlot(Handle handle) const;
+
+    /// Marks the start of a mutation for concurrent readers. Must be called with `lock` held.
+    void BeginWrite();
+
+    /// Marks the end of a mutation for concurrent readers. Must be called with `lock` held.
+    void EndWrite();
+
+    /**
+     * Releases the retired objects no reader can be using anymore, advancing the epoch as it
+     * goes. The objects are destroyed outside of `lock`.
+     */
+    void ReclaimRetired() const;
+
+    /// Number of reader counters, which are picked by host thread to avoid sharing cache lines.
+    static constexpr std::size_t NUM_READER_COUNTS = 8;
+
+    struct alignas(64) ReaderCounts {
+        /// Readers that entered while the epoch had the given parity.
+        std::array<std::atomic<u32>, 2> counts{};
+    };
+
     /// Stores the Object referenced by the handle or null if the slot is empty.
     std::array<std::shared_ptr<Object>, MAX_COUNT> objects;
 
+    /// Borrowed mirror of `objects`, readable without holding `lock`.
+    std::array<std::atomic<Object*>, MAX_COUNT> slot_objects{};
+
+    /// Generation of the handle occupying each slot, or zero if the slot is empty.
+    std::array<std::atomic<u16>, MAX_COUNT> slot_generations{};
+
+    /// Sequence counter for lock-free readers. Odd while a mutation is in progress.
+    std::atomic<u32> sequence{0};
+
+    /// Serializes mutations of the table and the reclamation of retired objects.
+    mutable Common::SpinLock lock;
+
+    /// Readers currently inside a BorrowGuard, by host thread and epoch parity.
+    mutable std::array<ReaderCounts, NUM_READER_COUNTS> reader_counts{};
+
+    /// Reclamation epoch, only its parity is used by readers.
+    mutable std::atomic<u32> epoch{0};
+
+    /// Whether there are retired objects left to release, checked by readers as they leave.
+    mutable std::atomic_bool has_retired{false};
+
+    /// Objects closed before the epoch was last advanced.
+    mutable std::vector<std::shared_ptr<Object>> retired_previous;
+
+    /// Objects closed since the epoch was last advanced.
+    mutable std::vector<std::shared_ptr<Object>> retired_current;
+
     /**
      * The value of `next_generation` when the handle was created, used to check for validity. For
      * empty slots, contains the index of the next free slot in the list.
@@ -46,6 +46,19 @@
 MICROPROFILE_DEFINE(Kernel_SVC, "Kernel", "SVC", MP_RGB(70, 200, 70));
 
 namespace Kernel {
+namespace {
+/// Host thread registration, cached per thread so lookups don't need to search a table.
+struct HostThreadRegistration {
+    u64 epoch{};
+    u32 id{Core::INVALID_HOST_THREAD_ID};
+    bool is_single_core_thread{};
+};
+
+thread_local HostThreadRegistration current_host_thread;
+
+/// Source of unique registration epochs, shared by all kernel instances.
+std::atomic<u64> next_registration_epoch{0};
+} // Anonymous namespace
 
 struct KernelCore::Impl {
     explicit Impl(Core::System& system, KernelCore& kernel)
@@ -111,10 +124,9 @@ struct KernelCore::Impl {
 
         exclusive_monitor.reset();
 
+        // Invalidate every cached host thread registration made under the previous epoch.
         num_host_threads = 0;
-        std::fill(register_host_thread_keys.begin(), register_host_thread_keys.end(),
-                  std::thread::id{});
-        std::fill(register_host_thread_values.begin(), register_host_thread_values.end(), 0);
+        registration_epoch = ++next_registration_epoch;
     }
 
     void InitializePhysicalCores() {
@@ -195,48 +207,39 @@ struct KernelCore::Impl {
     }
 
     void RegisterCoreThread(std::size_t core_id) {
-        const std::thread::id this_id = std::this_thread::get_id();
-        if (!is_multicore) {
-            single_core_thread_id = this_id;
-        }
-        const auto end =
-            register_host_thread_keys.begin() + static_cast<ptrdiff_t>(num_host_threads);
-        const auto it = std::find(register_host_thread_keys.begin(), end, this_id);
         ASSERT(core_id < Core::Hardware::NUM_CPU_CORES);
-        ASSERT(it == end);
-        InsertHostThread(static_cast<u32>(core_id));
+        ASSERT(!IsCurrentHostThreadRegistered());
+        InsertHostThread(static_cast<u32>(core_id), !is_multicore);
     }
 
     void RegisterHostThread() {
-        const std::thread::id this_id = std::this_thread::get_id();
-        const auto end =
-            register_host_thread_keys.begin() + static_cast<ptrdiff_t>(num_host_threads);
-        const auto it = std::find(register_host_thread_keys.begin(), end, this_id);
-        if (it == end) {
-            InsertHostThread(registered_thread_ids++);
+        if (!IsCurrentHostThreadRegistered()) {
+            InsertHostThread(registered_thread_ids++, false);
         }
     }
 
-    void InsertHostThread(u32 value) {
+    void InsertHostThread(u32 value, bool is_single_core_thread) {
         const size_t index = num_host_threads++;
         ASSERT_MSG(index < NUM_REGISTRABLE_HOST_THREADS, "Too many host threads");
-        register_host_thread_values[index] = value;
-        register_host_thread_keys[index] = std::this_thread::get_id();
+        current_host_thread = {
+            .epoch = registration_epoch,
+            .id = value,
+            .is_single_core_thread = is_single_core_thread,
+        };
+    }
+
+    [[nodiscard]] bool IsCurrentHostThreadRegistered() const {
+        return current_host_thread.epoch == registration_epoch;
     }
 
     [[nodiscard]] u32 GetCurrentHostThreadID() const {
-        const std::thread::id this_id = std::this_thread::get_id();
-        if (!is_multicore && single_core_thread_id == this_id) {
-            return static_cast<u32>(system.GetCpuManager().CurrentCore());
-        }
-        const auto end =
-            register_host_thread_keys.begin() + static_cast<ptrdiff_t>(num_host_threads);
-        const auto it = std::find(register_host_thread_keys.begin(), end, this_id);
-        if (it == end) {
+        if (!IsCurrentHostThreadRegistered()) {
             return Core::INVALID_HOST_THREAD_ID;
         }
-        return register_host_thread_values[static_cast<size_t>(
-            std::distance(register_host_thread_keys.begin(), it))];
+        if (current_host_thread.is_single_core_thread) {
+            return static_cast<u32>(system.GetCpuManager().CurrentCore());
+        }
+        return current_host_thread.id;
     }
 
     Core::EmuThreadHandle GetCurrentEmuThreadID() const {
@@ -339,9 +342,9 @@ struct KernelCore::Impl {
     // Number of host threads is a relatively high number to avoid overflowing
     static constexpr size_t NUM_REGISTRABLE_HOST_THREADS = 64;
     std::atomic<size_t> num_host_threads{0};
-    std::array<std::atomic<std::thread::id>, NUM_REGISTRABLE_HOST_THREADS>
-        register_host_thread_keys{};
-    std::array<std::atomic<u32>, NUM_REGISTRABLE_HOST_THREADS> register_host_thread_values{};
+
+    // Registrations cached in current_host_thread are only valid for the epoch they were made in
+    u64 registration_epoch{++next_registration_epoch};
 
     // Kernel memory management
     std::unique_ptr<Memory::MemoryManager> memory_manager;
@@ -358,7 +361,6 @@ struct KernelCore::Impl {
     std::array<std::unique_ptr<Kernel::Scheduler>, Core::Hardware::NUM_CPU_CORES> schedulers{};
 
     bool is_multicore{};
-    std::thread::id single_core_thread_id{};
 
     std::array<u64, Core::Hardware::NUM_CPU_CORES> svc_ticks{};
 
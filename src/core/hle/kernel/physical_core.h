@@ -44,6 +44,7 @@ public:
     /// Execute current jit state
     void Run();
 
+    /// Park the host thread until a scheduling action interrupts this core.
     void Idle();
 
     /// Interrupt this physical core.
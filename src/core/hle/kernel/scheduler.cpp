@@ -274,6 +274,13 @@ void GlobalScheduler::PreemptThreads() {
     for (std::size_t core_id = 0; core_id < Core::Hardware::NUM_CPU_CORES; core_id++) {
         const u32 priority = preemption_priorities[core_id];
 
+        // Without competing threads nothing can be rotated or migrated, so skip the scan of the
+        // suggested threads. Once every core is skipped, no reselection pass is needed either.
+        const bool has_rotation = scheduled_queue[core_id].size(priority) > 1;
+        if (!has_rotation && suggested_queue[core_id].empty()) {
+            continue;
+        }
+
         if (scheduled_queue[core_id].size(priority) > 0) {
             if (scheduled_queue[core_id].size(priority) > 1) {
                 scheduled_queue[core_id].front(priority)->IncrementYieldCount();
@@ -346,6 +353,7 @@ void GlobalScheduler::PreemptThreads() {
             }
         }
 
+        // Reselect even without a winner, as suggested threads are migrated onto idle cores there.
         is_reselection_pending.store(true, std::memory_order_release);
     }
 }
@@ -103,7 +103,8 @@ public:
     /**
      * Rotates the scheduling queues of threads at a preemption priority and then does
      * some core rebalancing. Preemption priorities can be found in the array
-     * 'preemption_priorities'.
+     * 'preemption_priorities'. Cores with neither threads to rotate at their preemption priority
+     * nor suggested threads are skipped, and do not request a reselection.
      *
      * @note This operation happens every 10ms.
      */
@@ -374,7 +374,8 @@ static ResultCode GetThreadId(Core::System& system, u64* thread_id, Handle threa
     LOG_TRACE(Kernel_SVC, "called thread=0x{:08X}", thread_handle);
 
     const auto& handle_table = system.Kernel().CurrentProcess()->GetHandleTable();
-    const std::shared_ptr<Thread> thread = handle_table.Get<Thread>(thread_handle);
+    const HandleTable::BorrowGuard guard{handle_table};
+    const Thread* const thread = handle_table.GetPtr<Thread>(guard, thread_handle);
     if (!thread) {
         LOG_ERROR(Kernel_SVC, "Thread handle does not exist, handle=0x{:08X}", thread_handle);
         return ERR_INVALID_HANDLE;
@@ -400,13 +401,14 @@ static ResultCode GetProcessId(Core::System& system, u64* process_id, Handle han
     LOG_DEBUG(Kernel_SVC, "called handle=0x{:08X}", handle);
 
     const auto& handle_table = system.Kernel().CurrentProcess()->GetHandleTable();
-    const std::shared_ptr<Process> process = handle_table.Get<Process>(handle);
+    const HandleTable::BorrowGuard guard{handle_table};
+    const Process* const process = handle_table.GetPtr<Process>(guard, handle);
     if (process) {
         *process_id = process->GetProcessID();
         return RESULT_SUCCESS;
     }
 
-    const std::shared_ptr<Thread> thread = handle_table.Get<Thread>(handle);
+    const Thread* const thread = handle_table.GetPtr<Thread>(guard, handle);
     if (thread) {
         const Process* const owner_process = thread->GetOwnerProcess();
         if (!owner_process) {
@@ -1148,7 +1150,8 @@ static ResultCode GetThreadPriority(Core::System& system, u32* priority, Handle
     LOG_TRACE(Kernel_SVC, "called");
 
     const auto& handle_table = system.Kernel().CurrentProcess()->GetHandleTable();
-    const std::shared_ptr<Thread> thread = handle_table.Get<Thread>(handle);
+    const HandleTable::BorrowGuard guard{handle_table};
+    const Thread* const thread = handle_table.GetPtr<Thread>(guard, handle);
     if (!thread) {
         *priority = 0;
         LOG_ERROR(Kernel_SVC, "Thread handle does not exist, handle=0x{:08X}", handle);
@@ -1177,7 +1180,9 @@ static ResultCode SetThreadPriority(Core::System& system, Handle handle, u32 pri
 
     const auto* const current_process = system.Kernel().CurrentProcess();
 
-    std::shared_ptr<Thread> thread = current_process->GetHandleTable().Get<Thread>(handle);
+    const auto& handle_table = current_process->GetHandleTable();
+    const HandleTable::BorrowGuard guard{handle_table};
+    Thread* const thread = handle_table.GetPtr<Thread>(guard, handle);
     if (!thread) {
         LOG_ERROR(Kernel_SVC, "Thread handle does not exist, handle=0x{:08X}", handle);
         return ERR_INVALID_HANDLE;
@@ -1906,13 +1911,14 @@ static ResultCode ResetSignal(Core::System& system, Handle handle) {
     LOG_DEBUG(Kernel_SVC, "called handle 0x{:08X}", handle);
 
     const auto& handle_table = system.Kernel().CurrentProcess()->GetHandleTable();
+    const HandleTable::BorrowGuard guard{handle_table};
 
-    auto event = handle_table.Get<ReadableEvent>(handle);
+    auto* const event = handle_table.GetPtr<ReadableEvent>(guard, handle);
     if (event) {
         return event->Reset();
     }
 
-    auto process = handle_table.Get<Process>(handle);
+    auto* const process = handle_table.GetPtr<Process>(guard, handle);
     if (process) {
         return process->ClearSignalState();
     }
@@ -1983,7 +1989,8 @@ static ResultCode GetThreadCoreMask(Core::System& system, Handle thread_handle,
     LOG_TRACE(Kernel_SVC, "called, handle=0x{:08X}", thread_handle);
 
     const auto& handle_table = system.Kernel().CurrentProcess()->GetHandleTable();
-    const std::shared_ptr<Thread> thread = handle_table.Get<Thread>(thread_handle);
+    const HandleTable::BorrowGuard guard{handle_table};
+    const Thread* const thread = handle_table.GetPtr<Thread>(guard, thread_handle);
     if (!thread) {
         LOG_ERROR(Kernel_SVC, "Thread handle does not exist, thread_handle=0x{:08X}",
                   thread_handle);
@@ -2105,14 +2112,15 @@ static ResultCode ClearEvent(Core::System& system, Handle handle) {
     LOG_TRACE(Kernel_SVC, "called, event=0x{:08X}", handle);
 
     const auto& handle_table = system.Kernel().CurrentProcess()->GetHandleTable();
+    const HandleTable::BorrowGuard guard{handle_table};
 
-    auto writable_event = handle_table.Get<WritableEvent>(handle);
+    auto* const writable_event = handle_table.GetPtr<WritableEvent>(guard, handle);
     if (writable_event) {
         writable_event->Clear();
         return RESULT_SUCCESS;
     }
 
-    auto readable_event = handle_table.Get<ReadableEvent>(handle);
+    auto* const readable_event = handle_table.GetPtr<ReadableEvent>(guard, handle);
     if (readable_event) {
         readable_event->Clear();
         return RESULT_SUCCESS;
@@ -2130,7 +2138,8 @@ static ResultCode SignalEvent(Core::System& system, Handle handle) {
     LOG_DEBUG(Kernel_SVC, "called. Handle=0x{:08X}", handle);
 
     HandleTable& handle_table = system.Kernel().CurrentProcess()->GetHandleTable();
-    auto writable_event = handle_table.Get<WritableEvent>(handle);
+    const HandleTable::BorrowGuard guard{handle_table};
+    auto* const writable_event = handle_table.GetPtr<WritableEvent>(guard, handle);
 
     if (!writable_event) {
         LOG_ERROR(Kernel_SVC, "Non-existent writable event handle used (0x{:08X})", handle);
@@ -11,6 +11,7 @@
 #include "core/file_sys/card_image.h"
 #include "core/file_sys/control_metadata.h"
 #include "core/file_sys/errors.h"
+#include "core/file_sys/journaled_savedata.h"
 #include "core/file_sys/mode.h"
 #include "core/file_sys/partition_filesystem.h"
 #include "core/file_sys/patch_manager.h"
@@ -246,6 +247,16 @@ ResultVal<FileSys::EntryType> VfsDirectoryServiceWrapper::GetEntryType(
     return FileSys::ERROR_PATH_NOT_FOUND;
 }
 
+ResultCode VfsDirectoryServiceWrapper::Commit() const {
+    const auto journaled = std::dynamic_pointer_cast<FileSys::JournaledSaveDirectory>(backing);
+    if (journaled != nullptr && !journaled->Commit()) {
+        // Commits only fail when the host could not write the save data, most often for lack of
+        // space, which is what the guest is told.
+        return FileSys::ERROR_NOT_ENOUGH_FREE_SPACE;
+    }
+    return RESULT_SUCCESS;
+}
+
 FileSystemController::FileSystemController(Core::System& system_) : system{system_} {}
 
 FileSystemController::~FileSystemController() = default;
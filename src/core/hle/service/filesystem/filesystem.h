@@ -237,6 +237,12 @@ public:
      */
     ResultVal<FileSys::EntryType> GetEntryType(const std::string& path) const;
 
+    /**
+     * Commit the changes made to the archive, if it holds them back until then
+     * @return Result of the operation
+     */
+    ResultCode Commit() const;
+
 private:
     FileSys::VirtualDir backing;
 };
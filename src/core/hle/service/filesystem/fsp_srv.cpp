@@ -24,6 +24,7 @@
 #include "core/file_sys/savedata_factory.h"
 #include "core/file_sys/system_archive/system_archive.h"
 #include "core/file_sys/vfs.h"
+#include "core/file_sys/vfs_read_ahead.h"
 #include "core/hle/ipc_helpers.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/service/filesystem/filesystem.h"
@@ -58,7 +59,8 @@ enum class FileSystemType : u8 {
 class IStorage final : public ServiceFramework<IStorage> {
 public:
     explicit IStorage(Core::System& system_, FileSys::VirtualFile backend_)
-        : ServiceFramework{system_, "IStorage"}, backend(std::move(backend_)) {
+        : ServiceFramework{system_, "IStorage"},
+          backend(std::make_shared<FileSys::ReadAheadVfsFile>(std::move(backend_))) {
         static const FunctionInfo functions[] = {
             {0, &IStorage::Read, "Read"},
             {1, nullptr, "Write"},
@@ -235,37 +237,39 @@ private:
     }
 };
 
-template <typename T>
-static void BuildEntryIndex(std::vector<FileSys::Entry>& entries, const std::vector<T>& new_data,
-                            FileSys::EntryType type) {
-    entries.reserve(entries.size() + new_data.size());
-
-    for (const auto& new_entry : new_data) {
-        entries.emplace_back(new_entry->GetName(), type, new_entry->GetSize());
-    }
-}
-
 class IDirectory final : public ServiceFramework<IDirectory> {
 public:
     explicit IDirectory(Core::System& system_, FileSys::VirtualDir backend_)
-        : ServiceFramework{system_, "IDirectory"}, backend(std::move(backend_)) {
+        : ServiceFramework{system_, "IDirectory"}, backend(std::move(backend_)),
+          files(backend->GetFiles()), subdirectories(backend->GetSubdirectories()) {
         static const FunctionInfo functions[] = {
             {0, &IDirectory::Read, "Read"},
             {1, &IDirectory::GetEntryCount, "GetEntryCount"},
         };
         RegisterHandlers(functions);
-
-        // TODO(DarkLordZach): Verify that this is the correct behavior.
-        // Build entry index now to save time later.
-        BuildEntryIndex(entries, backend->GetFiles(), FileSys::EntryType::File);
-        BuildEntryIndex(entries, backend->GetSubdirectories(), FileSys::EntryType::Directory);
     }
 
 private:
     FileSys::VirtualDir backend;
-    std::vector<FileSys::Entry> entries;
+    // Listed when opened, but entries are only built once read, as finding the size of a file can
+    // mean asking the host for it and the size of a directory means walking all of its contents.
+    std::vector<FileSys::VirtualFile> files;
+    std::vector<FileSys::VirtualDir> subdirectories;
     u64 next_entry_index = 0;
 
+    u64 GetTotalEntryCount() const {
+        return files.size() + subdirectories.size();
+    }
+
+    FileSys::Entry BuildEntry(u64 index) const {
+        if (index < files.size()) {
+            const auto& file = files[index];
+            return {file->GetName(), FileSys::EntryType::File, file->GetSize()};
+        }
+        const auto& subdirectory = subdirectories[index - files.size()];
+        return {subdirectory->GetName(), FileSys::EntryType::Directory, subdirectory->GetSize()};
+    }
+
     void Read(Kernel::HLERequestContext& ctx) {
         LOG_DEBUG(Service_FS, "called.");
 
@@ -273,17 +277,19 @@ private:
         const u64 count_entries = ctx.GetWriteBufferSize() / sizeof(FileSys::Entry);
 
         // Cap at total number of entries.
-        const u64 actual_entries = std::min(count_entries, entries.size() - next_entry_index);
+        const u64 actual_entries =
+            std::min(count_entries, GetTotalEntryCount() - next_entry_index);
 
-        // Determine data start and end
-        const auto* begin = reinterpret_cast<u8*>(entries.data() + next_entry_index);
-        const auto* end = reinterpret_cast<u8*>(entries.data() + next_entry_index + actual_entries);
-        const auto range_size = static_cast<std::size_t>(std::distance(begin, end));
+        std::vector<FileSys::Entry> entries;
+        entries.reserve(actual_entries);
+        for (u64 i = 0; i < actual_entries; ++i) {
+            entries.push_back(BuildEntry(next_entry_index + i));
+        }
 
         next_entry_index += actual_entries;
 
         // Write the data to memory
-        ctx.WriteBuffer(begin, range_size);
+        ctx.WriteBuffer(entries.data(), entries.size() * sizeof(FileSys::Entry));
 
         IPC::ResponseBuilder rb{ctx, 4};
         rb.Push(RESULT_SUCCESS);
@@ -293,7 +299,7 @@ private:
     void GetEntryCount(Kernel::HLERequestContext& ctx) {
         LOG_DEBUG(Service_FS, "called");
 
-        u64 count = entries.size() - next_entry_index;
+        u64 count = GetTotalEntryCount() - next_entry_index;
 
         IPC::ResponseBuilder rb{ctx, 4};
         rb.Push(RESULT_SUCCESS);
@@ -473,10 +479,10 @@ public:
     }
 
     void Commit(Kernel::HLERequestContext& ctx) {
-        LOG_WARNING(Service_FS, "(STUBBED) called");
+        LOG_DEBUG(Service_FS, "called");
 
         IPC::ResponseBuilder rb{ctx, 2};
-        rb.Push(RESULT_SUCCESS);
+        rb.Push(backend.Commit());
     }
 
     void GetFreeSpaceSize(Kernel::HLERequestContext& ctx) {
@@ -2,8 +2,11 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
 #include <cinttypes>
 #include <cstring>
+#include <future>
 #include <vector>
 
 #include "common/common_funcs.h"
@@ -35,17 +38,6 @@ struct MODHeader {
 };
 static_assert(sizeof(MODHeader) == 0x1c, "MODHeader has incorrect size.");
 
-std::vector<u8> DecompressSegment(const std::vector<u8>& compressed_data,
-                                  const NSOSegmentHeader& header) {
-    std::vector<u8> uncompressed_data =
-        Common::Compression::DecompressDataLZ4(compressed_data, header.size);
-
-    ASSERT_MSG(uncompressed_data.size() == header.size, "{} != {}", header.size,
-               uncompressed_data.size());
-
-    return uncompressed_data;
-}
-
 constexpr u32 PageAlignSize(u32 size) {
     return static_cast<u32>((size + Core::Memory::PAGE_MASK) & ~Core::Memory::PAGE_MASK);
 }
@@ -88,62 +80,81 @@ std::optional<VAddr> AppLoader_NSO::LoadModule(Kernel::Process& process, Core::S
         return std::nullopt;
     }
 
-    // Build program image
+    // Lay out the program image. Everything but the segment data is known from the header, so
+    // the code layout is computed without decompressing anything.
     Kernel::CodeSet codeset;
-    Kernel::PhysicalMemory program_image;
+    std::size_t data_end = 0;
+    for (std::size_t i = 0; i < nso_header.segments.size(); ++i) {
+        const auto& segment = nso_header.segments[i];
+        const std::size_t stored_size = nso_header.IsSegmentCompressed(i)
+                                            ? segment.size
+                                            : nso_header.segments_compressed_size[i];
+        data_end = std::max<std::size_t>(data_end, segment.location + stored_size);
+        codeset.segments[i].addr = segment.location;
+        codeset.segments[i].offset = segment.location;
+        codeset.segments[i].size = segment.size;
+    }
+
+    const auto& arg_data = Settings::values.program_args;
+    const bool pass_arguments = should_pass_arguments && !arg_data.empty();
+    const std::size_t arguments_end =
+        data_end + (pass_arguments ? NSO_ARGUMENT_DATA_ALLOCATION_SIZE : 0);
+    const u32 image_size{
+        PageAlignSize(static_cast<u32>(arguments_end) + nso_header.segments[2].bss_size)};
+
+    // If we aren't actually loading (i.e. just computing the process code layout), we are done
+    if (!load_into_process) {
+        return load_base + image_size;
+    }
+
+    // Build program image. The segments are read one after another, as the file may not be read
+    // from several threads, and then decompressed concurrently straight into the image.
+    Kernel::PhysicalMemory program_image(image_size);
+    std::array<std::vector<u8>, 3> compressed_segments;
+    std::vector<std::future<bool>> decompressions;
     for (std::size_t i = 0; i < nso_header.segments.size(); ++i) {
-        std::vector<u8> data =
-            file.ReadBytes(nso_header.segments_compressed_size[i], nso_header.segments[i].offset);
-        if (nso_header.IsSegmentCompressed(i)) {
-            data = DecompressSegment(data, nso_header.segments[i]);
+        const auto& segment = nso_header.segments[i];
+        u8* const destination = program_image.data() + segment.location;
+        if (!nso_header.IsSegmentCompressed(i)) {
+            file.Read(destination, nso_header.segments_compressed_size[i], segment.offset);
+            continue;
         }
-        program_image.resize(nso_header.segments[i].location + static_cast<u32>(data.size()));
-        std::memcpy(program_image.data() + nso_header.segments[i].location, data.data(),
-                    data.size());
-        codeset.segments[i].addr = nso_header.segments[i].location;
-        codeset.segments[i].offset = nso_header.segments[i].location;
-        codeset.segments[i].size = nso_header.segments[i].size;
+
+        compressed_segments[i] =
+            file.ReadBytes(nso_header.segments_compressed_size[i], segment.offset);
+        decompressions.push_back(std::async(
+            std::launch::async, [&compressed = compressed_segments[i], destination, &segment] {
+                return Common::Compression::DecompressDataLZ4(
+                    compressed.data(), compressed.size(), destination, segment.size);
+            }));
     }
 
-    if (should_pass_arguments && !Settings::values.program_args.empty()) {
-        const auto arg_data{Settings::values.program_args};
+    bool decompressed = true;
+    for (auto& decompression : decompressions) {
+        decompressed &= decompression.get();
+    }
+    if (!decompressed) {
+        LOG_ERROR(Loader, "Failed to decompress the segments of NSO {}", file.GetName());
+        return std::nullopt;
+    }
 
+    if (pass_arguments) {
         codeset.DataSegment().size += NSO_ARGUMENT_DATA_ALLOCATION_SIZE;
         NSOArgumentHeader args_header{
             NSO_ARGUMENT_DATA_ALLOCATION_SIZE, static_cast<u32_le>(arg_data.size()), {}};
-        const auto end_offset = program_image.size();
-        program_image.resize(static_cast<u32>(program_image.size()) +
-                             NSO_ARGUMENT_DATA_ALLOCATION_SIZE);
-        std::memcpy(program_image.data() + end_offset, &args_header, sizeof(NSOArgumentHeader));
-        std::memcpy(program_image.data() + end_offset + sizeof(NSOArgumentHeader), arg_data.data(),
+        std::memcpy(program_image.data() + data_end, &args_header, sizeof(NSOArgumentHeader));
+        std::memcpy(program_image.data() + data_end + sizeof(NSOArgumentHeader), arg_data.data(),
                     arg_data.size());
     }
 
     codeset.DataSegment().size += nso_header.segments[2].bss_size;
-    const u32 image_size{
-        PageAlignSize(static_cast<u32>(program_image.size()) + nso_header.segments[2].bss_size)};
-    program_image.resize(image_size);
-
     for (std::size_t i = 0; i < nso_header.segments.size(); ++i) {
         codeset.segments[i].size = PageAlignSize(codeset.segments[i].size);
     }
 
     // Apply patches if necessary
-    if (pm && (pm->HasNSOPatch(nso_header.build_id) || Settings::values.dump_nso)) {
-        std::vector<u8> pi_header;
-        pi_header.insert(pi_header.begin(), reinterpret_cast<u8*>(&nso_header),
-                         reinterpret_cast<u8*>(&nso_header) + sizeof(NSOHeader));
-        pi_header.insert(pi_header.begin() + sizeof(NSOHeader), program_image.data(),
-                         program_image.data() + program_image.size());
-
-        pi_header = pm->PatchNSO(pi_header, file.GetName());
-
-        std::copy(pi_header.begin() + sizeof(NSOHeader), pi_header.end(), program_image.data());
-    }
-
-    // If we aren't actually loading (i.e. just computing the process code layout), we are done
-    if (!load_into_process) {
-        return load_base + image_size;
+    if (pm) {
+        pm->PatchNSO(nso_header, program_image, file.GetName());
     }
 
     // Apply cheats if they exist and the program has a valid title ID
@@ -7,6 +7,7 @@
 #include "common/common_types.h"
 #include "core/core.h"
 #include "core/file_sys/card_image.h"
+#include "core/file_sys/container_cache.h"
 #include "core/file_sys/content_archive.h"
 #include "core/file_sys/control_metadata.h"
 #include "core/file_sys/nca_metadata.h"
@@ -25,7 +26,7 @@ AppLoader_NSP::AppLoader_NSP(FileSys::VirtualFile file,
                              const Service::FileSystem::FileSystemController& fsc,
                              const FileSys::ContentProvider& content_provider,
                              std::size_t program_index)
-    : AppLoader(file), nsp(std::make_unique<FileSys::NSP>(file, program_index)),
+    : AppLoader(file), nsp(FileSys::OpenNSP(file, program_index)),
       title_id(nsp->GetProgramTitleID()) {
 
     if (nsp->GetStatus() != ResultStatus::Success) {
@@ -58,20 +59,20 @@ AppLoader_NSP::AppLoader_NSP(FileSys::VirtualFile file,
 AppLoader_NSP::~AppLoader_NSP() = default;
 
 FileType AppLoader_NSP::IdentifyType(const FileSys::VirtualFile& file) {
-    FileSys::NSP nsp(file);
+    const auto nsp = FileSys::OpenNSP(file);
 
-    if (nsp.GetStatus() == ResultStatus::Success) {
+    if (nsp->GetStatus() == ResultStatus::Success) {
         // Extracted Type case
-        if (nsp.IsExtractedType() && nsp.GetExeFS() != nullptr &&
-            FileSys::IsDirectoryExeFS(nsp.GetExeFS())) {
+        if (nsp->IsExtractedType() && nsp->GetExeFS() != nullptr &&
+            FileSys::IsDirectoryExeFS(nsp->GetExeFS())) {
             return FileType::NSP;
         }
 
         // Non-Extracted Type case
-        if (!nsp.IsExtractedType() &&
-            nsp.GetNCA(nsp.GetFirstTitleID(), FileSys::ContentRecordType::Program) != nullptr &&
-            AppLoader_NCA::IdentifyType(nsp.GetNCAFile(
-                nsp.GetFirstTitleID(), FileSys::ContentRecordType::Program)) == FileType::NCA) {
+        if (!nsp->IsExtractedType() &&
+            nsp->GetNCA(nsp->GetFirstTitleID(), FileSys::ContentRecordType::Program) != nullptr &&
+            AppLoader_NCA::IdentifyType(nsp->GetNCAFile(
+                nsp->GetFirstTitleID(), FileSys::ContentRecordType::Program)) == FileType::NCA) {
             return FileType::NSP;
         }
     }
@@ -60,7 +60,7 @@ public:
     ResultStatus ReadNSOModules(Modules& modules) override;
 
 private:
-    std::unique_ptr<FileSys::NSP> nsp;
+    std::shared_ptr<FileSys::NSP> nsp;
     std::unique_ptr<AppLoader> secondary_loader;
 
     FileSys::VirtualFile icon_file;
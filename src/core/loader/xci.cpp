@@ -7,6 +7,7 @@
 #include "common/common_types.h"
 #include "core/core.h"
 #include "core/file_sys/card_image.h"
+#include "core/file_sys/container_cache.h"
 #include "core/file_sys/content_archive.h"
 #include "core/file_sys/control_metadata.h"
 #include "core/file_sys/patch_manager.h"
@@ -24,7 +25,7 @@ AppLoader_XCI::AppLoader_XCI(FileSys::VirtualFile file,
                              const Service::FileSystem::FileSystemController& fsc,
                              const FileSys::ContentProvider& content_provider,
                              std::size_t program_index)
-    : AppLoader(file), xci(std::make_unique<FileSys::XCI>(file, program_index)),
+    : AppLoader(file), xci(FileSys::OpenXCI(file, program_index)),
       nca_loader(std::make_unique<AppLoader_NCA>(xci->GetProgramNCAFile())) {
     if (xci->GetStatus() != ResultStatus::Success) {
         return;
@@ -44,11 +45,11 @@ AppLoader_XCI::AppLoader_XCI(FileSys::VirtualFile file,
 AppLoader_XCI::~AppLoader_XCI() = default;
 
 FileType AppLoader_XCI::IdentifyType(const FileSys::VirtualFile& file) {
-    FileSys::XCI xci(file);
+    const auto xci = FileSys::OpenXCI(file);
 
-    if (xci.GetStatus() == ResultStatus::Success &&
-        xci.GetNCAByType(FileSys::NCAContentType::Program) != nullptr &&
-        AppLoader_NCA::IdentifyType(xci.GetNCAFileByType(FileSys::NCAContentType::Program)) ==
+    if (xci->GetStatus() == ResultStatus::Success &&
+        xci->GetNCAByType(FileSys::NCAContentType::Program) != nullptr &&
+        AppLoader_NCA::IdentifyType(xci->GetNCAFileByType(FileSys::NCAContentType::Program)) ==
             FileType::NCA) {
         return FileType::XCI;
     }
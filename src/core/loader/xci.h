@@ -60,7 +60,7 @@ public:
     ResultStatus ReadNSOModules(Modules& modules) override;
 
 private:
-    std::unique_ptr<FileSys::XCI> xci;
+    std::shared_ptr<FileSys::XCI> xci;
     std::unique_ptr<AppLoader_NCA> nca_loader;
 
     FileSys::VirtualFile icon_file;
@@ -38,6 +38,10 @@ struct Memory::Impl {
         system.ArmInterface(core_id).PageTableChanged(*current_page_table, address_space_width);
     }
 
+    void SetCurrentPageTable(Common::PageTable& page_table) {
+        current_page_table = &page_table;
+    }
+
     void MapMemoryRegion(Common::PageTable& page_table, VAddr base, u64 size, PAddr target) {
         ASSERT_MSG((size & PAGE_MASK) == 0, "non-page aligned size: {:016X}", size);
         ASSERT_MSG((base & PAGE_MASK) == 0, "non-page aligned base: {:016X}", base);
@@ -718,7 +722,7 @@ struct Memory::Impl {
         case Common::PageType::RasterizerCachedMemory: {
             u8* host_ptr{GetPointerFromRasterizerCachedMemory(vaddr)};
             system.GPU().InvalidateRegion(vaddr, sizeof(T));
-            auto* pointer = reinterpret_cast<volatile T*>(&host_ptr);
+            auto* pointer = reinterpret_cast<volatile T*>(host_ptr);
             return Common::AtomicCompareAndSwap(pointer, data, expected);
         }
         default:
@@ -747,7 +751,7 @@ struct Memory::Impl {
         case Common::PageType::RasterizerCachedMemory: {
             u8* host_ptr{GetPointerFromRasterizerCachedMemory(vaddr)};
             system.GPU().InvalidateRegion(vaddr, sizeof(u128));
-            auto* pointer = reinterpret_cast<volatile u64*>(&host_ptr);
+            auto* pointer = reinterpret_cast<volatile u64*>(host_ptr);
             return Common::AtomicCompareAndSwap(pointer, data, expected);
         }
         default:
@@ -767,6 +771,10 @@ void Memory::SetCurrentPageTable(Kernel::Process& process, u32 core_id) {
     impl->SetCurrentPageTable(process, core_id);
 }
 
+void Memory::SetCurrentPageTable(Common::PageTable& page_table) {
+    impl->SetCurrentPageTable(page_table);
+}
+
 void Memory::MapMemoryRegion(Common::PageTable& page_table, VAddr base, u64 size, PAddr target) {
     impl->MapMemoryRegion(page_table, base, size, target);
 }
@@ -66,6 +66,14 @@ public:
      */
     void SetCurrentPageTable(Kernel::Process& process, u32 core_id);
 
+    /**
+     * Changes the currently active page table without notifying any CPU core. This is meant for
+     * harnesses that drive a CPU backend directly, outside of a running kernel.
+     *
+     * @param page_table The page table to make current.
+     */
+    void SetCurrentPageTable(Common::PageTable& page_table);
+
     /**
      * Maps an allocated buffer onto a region of the emulated process address space.
      *
@@ -29,6 +29,12 @@
 
 namespace Core::Memory {
 
+namespace {
+/// Writes are only combined within a page, as the callbacks validate the address a write starts at
+/// and memory regions are page aligned.
+constexpr u64 WRITE_BATCH_PAGE_SIZE = 0x1000;
+} // Anonymous namespace
+
 DmntCheatVm::DmntCheatVm(std::unique_ptr<Callbacks> callbacks) : callbacks(std::move(callbacks)) {}
 
 DmntCheatVm::~DmntCheatVm() = default;
@@ -641,26 +647,43 @@ bool DmntCheatVm::DecodeNextOpcode(CheatVmOpcode& out) {
     return valid;
 }
 
-void DmntCheatVm::SkipConditionalBlock() {
-    if (condition_depth > 0) {
-        // We want to continue until we're out of the current block.
-        const std::size_t desired_depth = condition_depth - 1;
-
-        CheatVmOpcode skip_opcode{};
-        while (condition_depth > desired_depth && DecodeNextOpcode(skip_opcode)) {
-            // Decode instructions until we see end of the current conditional block.
-            // NOTE: This is broken in gateway's implementation.
-            // Gateway currently checks for "0x2" instead of "0x20000000"
-            // In addition, they do a linear scan instead of correctly decoding opcodes.
-            // This causes issues if "0x2" appears as an immediate in the conditional block...
+void DmntCheatVm::DecodeProgram() {
+    instructions.clear();
+    instruction_ptr = 0;
+    decode_success = true;
 
-            // We also support nesting of conditional blocks, and Gateway does not.
-            if (skip_opcode.begin_conditional_block) {
-                condition_depth++;
-            } else if (std::holds_alternative<EndConditionalOpcode>(skip_opcode.opcode)) {
-                condition_depth--;
-            }
+    // Conditional blocks are matched up front, so that skipping one is a jump.
+    // NOTE: This is broken in gateway's implementation.
+    // Gateway currently checks for "0x2" instead of "0x20000000"
+    // In addition, they do a linear scan instead of correctly decoding opcodes.
+    // This causes issues if "0x2" appears as an immediate in the conditional block...
+    // We also support nesting of conditional blocks, and Gateway does not.
+    std::vector<std::size_t> open_blocks;
+    CheatVmOpcode opcode{};
+    while (DecodeNextOpcode(opcode)) {
+        const std::size_t index = instructions.size();
+        if (opcode.begin_conditional_block) {
+            open_blocks.push_back(index);
+        } else if (std::holds_alternative<EndConditionalOpcode>(opcode.opcode) &&
+                   !open_blocks.empty()) {
+            instructions[open_blocks.back()].block_end = index + 1;
+            open_blocks.pop_back();
         }
+        instructions.push_back({opcode, instruction_ptr, 0});
+    }
+
+    // Skipping a block that is never ended skips the rest of the program, just like decoding
+    // would fail past its end.
+    for (const std::size_t index : open_blocks) {
+        instructions[index].block_end = instructions.size();
+    }
+}
+
+void DmntCheatVm::SkipConditionalBlock(std::size_t block_end) {
+    if (condition_depth > 0) {
+        // Continue after the end of the current block.
+        instruction_ptr = block_end;
+        condition_depth--;
     } else {
         // Skipping, but condition_depth = 0.
         // This is an error condition.
@@ -671,6 +694,35 @@ void DmntCheatVm::SkipConditionalBlock() {
     }
 }
 
+void DmntCheatVm::ReadMemory(VAddr address, void* data, u64 size) {
+    // Reads have to observe the writes made before them.
+    FlushWrites();
+    callbacks->MemoryRead(address, data, size);
+}
+
+void DmntCheatVm::WriteMemory(VAddr address, const void* data, u64 size) {
+    const bool continues_write = !pending_write.empty() &&
+                                 address == pending_write_address + pending_write.size() &&
+                                 (address + size - 1) / WRITE_BATCH_PAGE_SIZE ==
+                                     pending_write_address / WRITE_BATCH_PAGE_SIZE;
+    if (!continues_write) {
+        FlushWrites();
+        pending_write_address = address;
+    }
+
+    const auto* bytes = static_cast<const u8*>(data);
+    pending_write.insert(pending_write.end(), bytes, bytes + size);
+}
+
+void DmntCheatVm::FlushWrites() {
+    if (pending_write.empty()) {
+        return;
+    }
+
+    callbacks->MemoryWrite(pending_write_address, pending_write.data(), pending_write.size());
+    pending_write.clear();
+}
+
 u64 DmntCheatVm::GetVmInt(VmInt value, u32 bit_width) {
     switch (bit_width) {
     case 1:
@@ -717,6 +769,7 @@ bool DmntCheatVm::LoadProgram(const std::vector<CheatEntry>& entries) {
             // Bounds check.
             if (entries[i].definition.num_opcodes + num_opcodes > MaximumProgramOpcodeCount) {
                 num_opcodes = 0;
+                instructions.clear();
                 return false;
             }
 
@@ -726,12 +779,11 @@ bool DmntCheatVm::LoadProgram(const std::vector<CheatEntry>& entries) {
         }
     }
 
+    DecodeProgram();
     return true;
 }
 
 void DmntCheatVm::Execute(const CheatProcessMetadata& metadata) {
-    CheatVmOpcode cur_opcode{};
-
     // Get Keys down.
     u64 kDown = callbacks->HidKeysDown();
 
@@ -744,9 +796,11 @@ void DmntCheatVm::Execute(const CheatProcessMetadata& metadata) {
     ResetState();
 
     // Loop until program finishes.
-    while (DecodeNextOpcode(cur_opcode)) {
+    while (instruction_ptr < instructions.size()) {
+        const auto& instruction = instructions[instruction_ptr++];
+        const auto& cur_opcode = instruction.opcode;
         callbacks->CommandLog(
-            fmt::format("Instruction Ptr: {:04X}", static_cast<u32>(instruction_ptr)));
+            fmt::format("Instruction Ptr: {:04X}", static_cast<u32>(instruction.next_dword_ptr)));
 
         for (std::size_t i = 0; i < NumRegisters; i++) {
             callbacks->CommandLog(fmt::format("Registers[{:02X}]: {:016X}", i, registers[i]));
@@ -773,7 +827,7 @@ void DmntCheatVm::Execute(const CheatProcessMetadata& metadata) {
             case 2:
             case 4:
             case 8:
-                callbacks->MemoryWrite(dst_address, &dst_value, store_static->bit_width);
+                WriteMemory(dst_address, &dst_value, store_static->bit_width);
                 break;
             }
         } else if (auto begin_cond = std::get_if<BeginConditionalOpcode>(&cur_opcode.opcode)) {
@@ -781,12 +835,12 @@ void DmntCheatVm::Execute(const CheatProcessMetadata& metadata) {
             u64 src_address =
                 GetCheatProcessAddress(metadata, begin_cond->mem_type, begin_cond->rel_address);
             u64 src_value = 0;
-            switch (store_static->bit_width) {
+            switch (begin_cond->bit_width) {
             case 1:
             case 2:
             case 4:
             case 8:
-                callbacks->MemoryRead(src_address, &src_value, begin_cond->bit_width);
+                ReadMemory(src_address, &src_value, begin_cond->bit_width);
                 break;
             }
             // Check against condition.
@@ -814,7 +868,7 @@ void DmntCheatVm::Execute(const CheatProcessMetadata& metadata) {
             }
             // Skip conditional block if condition not met.
             if (!cond_met) {
-                SkipConditionalBlock();
+                SkipConditionalBlock(instruction.block_end);
             }
         } else if (std::holds_alternative<EndConditionalOpcode>(cur_opcode.opcode)) {
             // Decrement the condition depth.
@@ -852,8 +906,7 @@ void DmntCheatVm::Execute(const CheatProcessMetadata& metadata) {
             case 2:
             case 4:
             case 8:
-                callbacks->MemoryRead(src_address, &registers[ldr_memory->reg_index],
-                                      ldr_memory->bit_width);
+                ReadMemory(src_address, &registers[ldr_memory->reg_index], ldr_memory->bit_width);
                 break;
             }
         } else if (auto str_static = std::get_if<StoreStaticToAddressOpcode>(&cur_opcode.opcode)) {
@@ -869,7 +922,7 @@ void DmntCheatVm::Execute(const CheatProcessMetadata& metadata) {
             case 2:
             case 4:
             case 8:
-                callbacks->MemoryWrite(dst_address, &dst_value, str_static->bit_width);
+                WriteMemory(dst_address, &dst_value, str_static->bit_width);
                 break;
             }
             // Increment register if relevant.
@@ -928,7 +981,7 @@ void DmntCheatVm::Execute(const CheatProcessMetadata& metadata) {
             // Check for keypress.
             if ((begin_keypress_cond->key_mask & kDown) != begin_keypress_cond->key_mask) {
                 // Keys not pressed. Skip conditional block.
-                SkipConditionalBlock();
+                SkipConditionalBlock(instruction.block_end);
             }
         } else if (auto perform_math_reg =
                        std::get_if<PerformArithmeticRegisterOpcode>(&cur_opcode.opcode)) {
@@ -1027,7 +1080,7 @@ void DmntCheatVm::Execute(const CheatProcessMetadata& metadata) {
             case 2:
             case 4:
             case 8:
-                callbacks->MemoryWrite(dst_address, &dst_value, str_register->bit_width);
+                WriteMemory(dst_address, &dst_value, str_register->bit_width);
                 break;
             }
 
@@ -1106,7 +1159,7 @@ void DmntCheatVm::Execute(const CheatProcessMetadata& metadata) {
                 case 2:
                 case 4:
                 case 8:
-                    callbacks->MemoryRead(cond_address, &cond_value, begin_reg_cond->bit_width);
+                    ReadMemory(cond_address, &cond_value, begin_reg_cond->bit_width);
                     break;
                 }
             }
@@ -1136,7 +1189,7 @@ void DmntCheatVm::Execute(const CheatProcessMetadata& metadata) {
 
             // Skip conditional block if condition not met.
             if (!cond_met) {
-                SkipConditionalBlock();
+                SkipConditionalBlock(instruction.block_end);
             }
         } else if (auto save_restore_reg =
                        std::get_if<SaveRestoreRegisterOpcode>(&cur_opcode.opcode)) {
@@ -1244,7 +1297,7 @@ void DmntCheatVm::Execute(const CheatProcessMetadata& metadata) {
                 case 2:
                 case 4:
                 case 8:
-                    callbacks->MemoryRead(val_address, &log_value, debug_log->bit_width);
+                    ReadMemory(val_address, &log_value, debug_log->bit_width);
                     break;
                 }
             }
@@ -1253,6 +1306,8 @@ void DmntCheatVm::Execute(const CheatProcessMetadata& metadata) {
             DebugLog(debug_log->log_id, log_value);
         }
     }
+
+    FlushWrites();
 }
 
 } // namespace Core::Memory
@@ -304,22 +304,44 @@ public:
     void Execute(const CheatProcessMetadata& metadata);
 
 private:
+    /// An instruction of the loaded program, decoded once when the program is loaded.
+    struct Instruction {
+        CheatVmOpcode opcode;
+        /// Offset in dwords of the instruction following this one.
+        std::size_t next_dword_ptr;
+        /// For instructions beginning a conditional block, the index of the instruction following
+        /// the end of the block.
+        std::size_t block_end;
+    };
+
     std::unique_ptr<Callbacks> callbacks;
 
     std::size_t num_opcodes = 0;
+    /// While decoding, the offset in dwords of the next opcode. While executing, the index of the
+    /// next instruction.
     std::size_t instruction_ptr = 0;
     std::size_t condition_depth = 0;
     bool decode_success = false;
     std::array<u32, MaximumProgramOpcodeCount> program{};
+    std::vector<Instruction> instructions;
     std::array<u64, NumRegisters> registers{};
     std::array<u64, NumRegisters> saved_values{};
     std::array<u64, NumStaticRegisters> static_registers{};
     std::array<std::size_t, NumRegisters> loop_tops{};
 
+    /// Writes to consecutive addresses, which are passed to the callbacks as a single write.
+    VAddr pending_write_address = 0;
+    std::vector<u8> pending_write;
+
     bool DecodeNextOpcode(CheatVmOpcode& out);
-    void SkipConditionalBlock();
+    void DecodeProgram();
+    void SkipConditionalBlock(std::size_t block_end);
     void ResetState();
 
+    void ReadMemory(VAddr address, void* data, u64 size);
+    void WriteMemory(VAddr address, const void* data, u64 size);
+    void FlushWrites();
+
     // For implementing the DebugLog opcode.
     void DebugLog(u32 log_id, u64 value);
 
@@ -210,6 +210,8 @@ struct Values {
     bool gamecard_inserted;
     bool gamecard_current_game;
     std::string gamecard_path;
+    bool verify_content_on_load;
+    bool journal_save_data;
 
     // Debugging
     bool record_frame_times;
@@ -2,6 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "core/core.h"
@@ -16,6 +20,10 @@ namespace {
 
 constexpr auto memory_freezer_ns = std::chrono::nanoseconds{1000000000 / 60};
 
+bool IsValidWidth(u32 width) {
+    return width == 1 || width == 2 || width == 4 || width == 8;
+}
+
 u64 MemoryReadWidth(Core::Memory::Memory& memory, u32 width, VAddr addr) {
     switch (width) {
     case 1:
@@ -32,25 +40,6 @@ u64 MemoryReadWidth(Core::Memory::Memory& memory, u32 width, VAddr addr) {
     }
 }
 
-void MemoryWriteWidth(Core::Memory::Memory& memory, u32 width, VAddr addr, u64 value) {
-    switch (width) {
-    case 1:
-        memory.Write8(addr, static_cast<u8>(value));
-        break;
-    case 2:
-        memory.Write16(addr, static_cast<u16>(value));
-        break;
-    case 4:
-        memory.Write32(addr, static_cast<u32>(value));
-        break;
-    case 8:
-        memory.Write64(addr, value);
-        break;
-    default:
-        UNREACHABLE();
-    }
-}
-
 } // Anonymous namespace
 
 Freezer::Freezer(Core::Timing::CoreTiming& core_timing_, Core::Memory::Memory& memory_)
@@ -87,6 +76,7 @@ void Freezer::Clear() {
     LOG_DEBUG(Common_Memory, "Clearing all frozen memory values.");
 
     entries.clear();
+    runs_outdated = true;
 }
 
 u64 Freezer::Freeze(VAddr address, u32 width) {
@@ -94,6 +84,7 @@ u64 Freezer::Freeze(VAddr address, u32 width) {
 
     const auto current_value = MemoryReadWidth(memory, width, address);
     entries.push_back({address, width, current_value});
+    runs_outdated = true;
 
     LOG_DEBUG(Common_Memory,
               "Freezing memory for address={:016X}, width={:02X}, current_value={:016X}", address,
@@ -108,6 +99,7 @@ void Freezer::Unfreeze(VAddr address) {
     LOG_DEBUG(Common_Memory, "Unfreezing memory for address={:016X}", address);
 
     std::erase_if(entries, [address](const Entry& entry) { return entry.address == address; });
+    runs_outdated = true;
 }
 
 bool Freezer::IsFrozen(VAddr address) const {
@@ -131,6 +123,7 @@ void Freezer::SetFrozenValue(VAddr address, u64 value) {
               "Manually overridden freeze value for address={:016X}, width={:02X} to value={:016X}",
               iter->address, iter->width, value);
     iter->value = value;
+    runs_outdated = true;
 }
 
 std::optional<Freezer::Entry> Freezer::GetEntry(VAddr address) const {
@@ -169,11 +162,27 @@ void Freezer::FrameCallback(std::uintptr_t, std::chrono::nanoseconds ns_late) {
 
     std::lock_guard lock{entries_mutex};
 
-    for (const auto& entry : entries) {
-        LOG_DEBUG(Common_Memory,
-                  "Enforcing memory freeze at address={:016X}, value={:016X}, width={:02X}",
-                  entry.address, entry.value, entry.width);
-        MemoryWriteWidth(memory, entry.width, entry.address, entry.value);
+    if (runs_outdated) {
+        BuildRuns();
+    }
+
+    for (const auto& run : runs) {
+        // Only the bytes the application has changed since the last frame are written back.
+        run_buffer.resize(run.data.size());
+        memory.ReadBlock(run.address, run_buffer.data(), run_buffer.size());
+        const auto first =
+            std::mismatch(run.data.begin(), run.data.end(), run_buffer.begin()).first;
+        if (first == run.data.end()) {
+            continue;
+        }
+        const auto last =
+            std::mismatch(run.data.rbegin(), run.data.rend(), run_buffer.rbegin()).first.base();
+
+        const auto offset = static_cast<std::size_t>(first - run.data.begin());
+        const auto size = static_cast<std::size_t>(last - first);
+        LOG_DEBUG(Common_Memory, "Enforcing memory freeze at address={:016X}, size={:X}",
+                  run.address + offset, size);
+        memory.WriteBlock(run.address + offset, run.data.data() + offset, size);
     }
 
     core_timing.ScheduleEvent(memory_freezer_ns - ns_late, event);
@@ -187,6 +196,41 @@ void Freezer::FillEntryReads() {
     for (auto& entry : entries) {
         entry.value = MemoryReadWidth(memory, entry.width, entry.address);
     }
+    runs_outdated = true;
+}
+
+void Freezer::BuildRuns() {
+    Entries sorted;
+    std::copy_if(entries.begin(), entries.end(), std::back_inserter(sorted),
+                 [](const Entry& entry) { return IsValidWidth(entry.width); });
+    std::sort(sorted.begin(), sorted.end(),
+              [](const Entry& lhs, const Entry& rhs) { return lhs.address < rhs.address; });
+
+    runs.clear();
+    for (const auto& entry : sorted) {
+        const VAddr end = entry.address + entry.width;
+        if (!runs.empty() && entry.address <= runs.back().address + runs.back().data.size()) {
+            auto& run = runs.back();
+            run.data.resize(std::max<std::size_t>(run.data.size(), end - run.address));
+        } else {
+            runs.push_back({entry.address, std::vector<u8>(entry.width)});
+        }
+    }
+
+    // Values are filled in the order they were frozen in, so that of overlapping entries, the one
+    // frozen last takes effect, as if each entry was written on its own.
+    for (const auto& entry : entries) {
+        if (!IsValidWidth(entry.width)) {
+            continue;
+        }
+        const auto next_run =
+            std::upper_bound(runs.begin(), runs.end(), entry.address,
+                             [](VAddr address, const Run& run) { return address < run.address; });
+        const auto run = std::prev(next_run);
+        std::memcpy(run->data.data() + (entry.address - run->address), &entry.value, entry.width);
+    }
+
+    runs_outdated = false;
 }
 
 } // namespace Tools
@@ -75,16 +75,29 @@ public:
 private:
     using Entries = std::vector<Entry>;
 
+    // The frozen values of entries at contiguous or overlapping addresses, merged so that they can
+    // be enforced with a single block access.
+    struct Run {
+        VAddr address;
+        std::vector<u8> data;
+    };
+
     Entries::iterator FindEntry(VAddr address);
     Entries::const_iterator FindEntry(VAddr address) const;
 
     void FrameCallback(std::uintptr_t user_data, std::chrono::nanoseconds ns_late);
     void FillEntryReads();
+    void BuildRuns();
 
     std::atomic_bool active{false};
 
     mutable std::mutex entries_mutex;
     Entries entries;
+    // Rebuilt from entries on the next frame whenever entries change.
+    std::vector<Run> runs;
+    bool runs_outdated = false;
+    // Holds the current contents of a run while comparing them to the frozen ones.
+    std::vector<u8> run_buffer;
 
     std::shared_ptr<Core::Timing::EventType> event;
     Core::Timing::CoreTiming& core_timing;
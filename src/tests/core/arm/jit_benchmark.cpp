@@ -0,0 +1,276 @@
+// Copyright 2020 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+// These benchmarks are hidden from the default test run. Run them with `tests "[benchmark]"`.
+
+#ifdef ARCHITECTURE_x86_64
+
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <memory>
+
+#include "common/bit_cast.h"
+#include "common/common_types.h"
+#include "common/page_table.h"
+#include "common/virtual_buffer.h"
+#include "core/arm/arm_interface.h"
+#include "core/arm/cpu_interrupt_handler.h"
+#include "core/arm/dynarmic/arm_dynarmic_32.h"
+#include "core/arm/dynarmic/arm_dynarmic_64.h"
+#include "core/arm/exclusive_monitor.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hardware_properties.h"
+#include "core/memory.h"
+
+namespace {
+
+constexpr u64 MEMORY_SIZE = 0x400000;
+constexpr VAddr CODE_BASE = 0x10000;
+constexpr VAddr SOURCE_BASE = 0x100000;
+constexpr VAddr DESTINATION_BASE = 0x200000;
+constexpr VAddr COUNTER_ADDRESS = 0x300000;
+constexpr u64 COPY_SIZE = 0x10000;
+
+constexpr std::size_t ADDRESS_SPACE_BITS_32 = 32;
+constexpr std::size_t ADDRESS_SPACE_BITS_64 = 36;
+
+constexpr auto BENCHMARK_DURATION = std::chrono::milliseconds{500};
+
+// ldp x3, x4, [x0], #16 ; stp x3, x4, [x1], #16 ; subs x2, x2, #1 ; b.ne -12
+// mov x0, x5 ; mov x1, x6 ; mov x2, x7 ; b -28
+constexpr std::array<u32, 8> MEMCPY_64{
+    0xa8c11003, 0xa8811023, 0xf1000442, 0x54ffffa1,
+    0xaa0503e0, 0xaa0603e1, 0xaa0703e2, 0x17fffff9,
+};
+
+// fmadd d0, d1, d2, d0 ; fmul d1, d1, d3 ; fadd d2, d2, d3 ; fdiv d3, d3, d1
+// fsqrt d4, d0 ; fmadd d0, d4, d3, d0 ; b -24
+constexpr std::array<u32, 7> FLOAT_MATH_64{
+    0x1f420020, 0x1e630821, 0x1e632842, 0x1e611863, 0x1e61c004, 0x1f430080, 0x17fffffa,
+};
+
+// ldaxr w1, [x0] ; add w1, w1, #1 ; stlxr w2, w1, [x0] ; cbnz w2, -12 ; b -16
+constexpr std::array<u32, 5> ATOMIC_INCREMENT_64{
+    0x885ffc01, 0x11000421, 0x8802fc01, 0x35ffffa2, 0x17fffffc,
+};
+
+// ldm r0!, {r3, r4, r8, r9} ; stm r1!, {r3, r4, r8, r9} ; subs r2, r2, #1 ; bne -20
+// mov r0, r5 ; mov r1, r6 ; mov r2, r7 ; b -36
+constexpr std::array<u32, 8> MEMCPY_32{
+    0xe8b00318, 0xe8a10318, 0xe2522001, 0x1afffffb,
+    0xe1a00005, 0xe1a01006, 0xe1a02007, 0xeafffff7,
+};
+
+// vmla.f64 d0, d1, d2 ; vmul.f64 d1, d1, d3 ; vadd.f64 d2, d2, d3 ; vdiv.f64 d3, d3, d1
+// vsqrt.f64 d4, d0 ; vmla.f64 d0, d4, d3 ; b -32
+constexpr std::array<u32, 7> FLOAT_MATH_32{
+    0xee010b02, 0xee211b03, 0xee322b03, 0xee833b01, 0xeeb14bc0, 0xee040b03, 0xeafffff8,
+};
+
+// ldrex r1, [r0] ; add r1, r1, #1 ; strex r2, r1, [r0] ; cmp r2, #0 ; bne -24 ; b -28
+constexpr std::array<u32, 6> ATOMIC_INCREMENT_32{
+    0xe1901f9f, 0xe2811001, 0xe1802f91, 0xe3520000, 0x1afffffa, 0xeafffff9,
+};
+
+/// Flat guest memory mapped at address zero through a regular page table, so that the JIT takes
+/// the same fast paths it does for guest heap and code memory.
+class JitBenchmarkEnvironment final {
+public:
+    explicit JitBenchmarkEnvironment(std::size_t address_space_bits_)
+        : system{Core::System::GetInstance()}, address_space_bits{address_space_bits_},
+          memory(MEMORY_SIZE) {
+        page_table.Resize(address_space_bits, Core::Memory::PAGE_BITS, true);
+        for (u64 offset = 0; offset < MEMORY_SIZE; offset += Core::Memory::PAGE_SIZE) {
+            const u64 page = offset >> Core::Memory::PAGE_BITS;
+            page_table.pointers[page] = memory.data() + offset - (page << Core::Memory::PAGE_BITS);
+            page_table.backing_addr[page] = 0;
+            page_table.attributes[page] = Common::PageType::Memory;
+        }
+        system.Memory().SetCurrentPageTable(page_table);
+        exclusive_monitor =
+            Core::MakeExclusiveMonitor(system.Memory(), Core::Hardware::NUM_CPU_CORES);
+    }
+
+    /// Creates a CPU backend of the given type running on this environment's memory.
+    template <typename CPU>
+    std::unique_ptr<CPU> MakeCpu(std::size_t core_index = 0) {
+        auto cpu = std::make_unique<CPU>(system, interrupts, false, *exclusive_monitor, core_index);
+        cpu->PageTableChanged(page_table, address_space_bits);
+        return cpu;
+    }
+
+    template <std::size_t N>
+    void WriteCode(const std::array<u32, N>& code) {
+        std::memcpy(GetPointer(CODE_BASE), code.data(), sizeof(code));
+    }
+
+    u8* GetPointer(VAddr vaddr) {
+        return memory.data() + vaddr;
+    }
+
+    void FillSource() {
+        for (u64 i = 0; i < COPY_SIZE; ++i) {
+            GetPointer(SOURCE_BASE)[i] = static_cast<u8>(i * 7);
+        }
+    }
+
+    bool IsCopyComplete() {
+        return std::memcmp(GetPointer(SOURCE_BASE), GetPointer(DESTINATION_BASE), COPY_SIZE) == 0;
+    }
+
+    u32 ReadCounter() {
+        u32 value;
+        std::memcpy(&value, GetPointer(COUNTER_ADDRESS), sizeof(value));
+        return value;
+    }
+
+    /// Runs the CPU in scheduler-sized slices for the benchmark duration and reports the results.
+    void Run(Core::ARM_Interface& cpu, const char* name) {
+        auto& core_timing = system.CoreTiming();
+        const u64 start_ticks = core_timing.GetCPUTicks();
+        const auto start_time = std::chrono::steady_clock::now();
+
+        u64 num_exits = 0;
+        auto current_time = start_time;
+        do {
+            core_timing.ResetTicks();
+            cpu.Run();
+            ++num_exits;
+            current_time = std::chrono::steady_clock::now();
+        } while (current_time - start_time < BENCHMARK_DURATION);
+
+        // Dynarmic reports executed instructions amortized over all emulated cores.
+        const u64 num_instructions =
+            (core_timing.GetCPUTicks() - start_ticks) * Core::Hardware::NUM_CPU_CORES;
+        const double seconds = std::chrono::duration<double>(current_time - start_time).count();
+        WARN(name << ": " << static_cast<u64>(num_instructions / seconds)
+                  << " guest instructions/s, " << static_cast<u64>(num_exits / seconds)
+                  << " JIT exits/s");
+    }
+
+private:
+    Core::System& system;
+    std::size_t address_space_bits;
+    Core::CPUInterrupts interrupts;
+    std::unique_ptr<Core::ExclusiveMonitor> exclusive_monitor;
+    Common::VirtualBuffer<u8> memory;
+    Common::PageTable page_table;
+};
+
+u128 MakeDouble(double value) {
+    return {Common::BitCast<u64>(value), 0};
+}
+
+void SetDouble(Core::ARM_Interface::ThreadContext32& ctx, std::size_t index, double value) {
+    const u64 bits = Common::BitCast<u64>(value);
+    ctx.extension_registers[index * 2] = static_cast<u32>(bits);
+    ctx.extension_registers[index * 2 + 1] = static_cast<u32>(bits >> 32);
+}
+
+constexpr u32 CPSR_USER_MODE = 0x10;
+
+} // Anonymous namespace
+
+TEST_CASE("ARM_Dynarmic_64::Memcpy", "[.][benchmark]") {
+    JitBenchmarkEnvironment env{ADDRESS_SPACE_BITS_64};
+    env.WriteCode(MEMCPY_64);
+    env.FillSource();
+
+    auto cpu = env.MakeCpu<Core::ARM_Dynarmic_64>();
+    Core::ARM_Interface::ThreadContext64 ctx{};
+    ctx.cpu_registers[0] = ctx.cpu_registers[5] = SOURCE_BASE;
+    ctx.cpu_registers[1] = ctx.cpu_registers[6] = DESTINATION_BASE;
+    ctx.cpu_registers[2] = ctx.cpu_registers[7] = COPY_SIZE / 16;
+    ctx.pc = CODE_BASE;
+    cpu->LoadContext(ctx);
+
+    env.Run(*cpu, "A64 memcpy");
+    REQUIRE(env.IsCopyComplete());
+}
+
+TEST_CASE("ARM_Dynarmic_64::FloatMath", "[.][benchmark]") {
+    JitBenchmarkEnvironment env{ADDRESS_SPACE_BITS_64};
+    env.WriteCode(FLOAT_MATH_64);
+
+    auto cpu = env.MakeCpu<Core::ARM_Dynarmic_64>();
+    Core::ARM_Interface::ThreadContext64 ctx{};
+    ctx.vector_registers[0] = MakeDouble(1.0);
+    ctx.vector_registers[1] = MakeDouble(1.0000001);
+    ctx.vector_registers[2] = MakeDouble(0.5);
+    ctx.vector_registers[3] = MakeDouble(0.9999999);
+    ctx.pc = CODE_BASE;
+    cpu->LoadContext(ctx);
+
+    env.Run(*cpu, "A64 float math");
+}
+
+TEST_CASE("ARM_Dynarmic_64::ExclusiveAtomics", "[.][benchmark]") {
+    JitBenchmarkEnvironment env{ADDRESS_SPACE_BITS_64};
+    env.WriteCode(ATOMIC_INCREMENT_64);
+
+    auto cpu = env.MakeCpu<Core::ARM_Dynarmic_64>();
+    Core::ARM_Interface::ThreadContext64 ctx{};
+    ctx.cpu_registers[0] = COUNTER_ADDRESS;
+    ctx.pc = CODE_BASE;
+    cpu->LoadContext(ctx);
+
+    env.Run(*cpu, "A64 exclusive atomics");
+    REQUIRE(env.ReadCounter() != 0);
+}
+
+TEST_CASE("ARM_Dynarmic_32::Memcpy", "[.][benchmark]") {
+    JitBenchmarkEnvironment env{ADDRESS_SPACE_BITS_32};
+    env.WriteCode(MEMCPY_32);
+    env.FillSource();
+
+    auto cpu = env.MakeCpu<Core::ARM_Dynarmic_32>();
+    Core::ARM_Interface::ThreadContext32 ctx{};
+    ctx.cpu_registers[0] = ctx.cpu_registers[5] = SOURCE_BASE;
+    ctx.cpu_registers[1] = ctx.cpu_registers[6] = DESTINATION_BASE;
+    ctx.cpu_registers[2] = ctx.cpu_registers[7] = COPY_SIZE / 16;
+    ctx.cpu_registers[15] = CODE_BASE;
+    ctx.cpsr = CPSR_USER_MODE;
+    cpu->LoadContext(ctx);
+
+    env.Run(*cpu, "A32 memcpy");
+    REQUIRE(env.IsCopyComplete());
+}
+
+TEST_CASE("ARM_Dynarmic_32::FloatMath", "[.][benchmark]") {
+    JitBenchmarkEnvironment env{ADDRESS_SPACE_BITS_32};
+    env.WriteCode(FLOAT_MATH_32);
+
+    auto cpu = env.MakeCpu<Core::ARM_Dynarmic_32>();
+    Core::ARM_Interface::ThreadContext32 ctx{};
+    SetDouble(ctx, 0, 1.0);
+    SetDouble(ctx, 1, 1.0000001);
+    SetDouble(ctx, 2, 0.5);
+    SetDouble(ctx, 3, 0.9999999);
+    ctx.cpu_registers[15] = CODE_BASE;
+    ctx.cpsr = CPSR_USER_MODE;
+    cpu->LoadContext(ctx);
+
+    env.Run(*cpu, "A32 float math");
+}
+
+TEST_CASE("ARM_Dynarmic_32::ExclusiveAtomics", "[.][benchmark]") {
+    JitBenchmarkEnvironment env{ADDRESS_SPACE_BITS_32};
+    env.WriteCode(ATOMIC_INCREMENT_32);
+
+    auto cpu = env.MakeCpu<Core::ARM_Dynarmic_32>();
+    Core::ARM_Interface::ThreadContext32 ctx{};
+    ctx.cpu_registers[0] = COUNTER_ADDRESS;
+    ctx.cpu_registers[15] = CODE_BASE;
+    ctx.cpsr = CPSR_USER_MODE;
+    cpu->LoadContext(ctx);
+
+    env.Run(*cpu, "A32 exclusive atomics");
+    REQUIRE(env.ReadCounter() != 0);
+}
+
+#endif // ARCHITECTURE_x86_64
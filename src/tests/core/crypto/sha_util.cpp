@@ -0,0 +1,54 @@
+// Copyright 2020 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <string_view>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/hex_util.h"
+#include "core/crypto/sha_util.h"
+
+namespace Core::Crypto {
+
+namespace {
+SHA256Hash HashString(std::string_view str) {
+    return CalculateSHA256(reinterpret_cast<const u8*>(str.data()), str.size());
+}
+} // Anonymous namespace
+
+TEST_CASE("SHA256::KnownAnswers", "[core][crypto]") {
+    REQUIRE(HashString("") ==
+            Common::HexStringToArray<32>(
+                "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"));
+    REQUIRE(HashString("abc") ==
+            Common::HexStringToArray<32>(
+                "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"));
+    REQUIRE(HashString("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq") ==
+            Common::HexStringToArray<32>(
+                "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"));
+
+    const std::vector<u8> million_a(1000000, 'a');
+    REQUIRE(CalculateSHA256(million_a) ==
+            Common::HexStringToArray<32>(
+                "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"));
+}
+
+TEST_CASE("SHA256::Streaming", "[core][crypto]") {
+    std::vector<u8> data(0x1000);
+    for (std::size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<u8>(i * 7);
+    }
+    const auto expected = CalculateSHA256(data);
+
+    // Feed the data in uneven pieces so updates straddle block boundaries.
+    for (std::size_t piece_size : {1, 3, 63, 64, 65, 1000}) {
+        SHA256Hasher hasher;
+        for (std::size_t offset = 0; offset < data.size(); offset += piece_size) {
+            hasher.Update(data.data() + offset, std::min(piece_size, data.size() - offset));
+        }
+        REQUIRE(hasher.Finish() == expected);
+    }
+}
+
+} // namespace Core::Crypto
@@ -0,0 +1,66 @@
+// Copyright 2020 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/file_util.h"
+#include "core/file_sys/journaled_savedata.h"
+#include "core/file_sys/mode.h"
+#include "core/file_sys/vfs_real.h"
+
+namespace FileSys {
+
+TEST_CASE("SaveDataJournal::CommitAndRevert", "[core][file_sys]") {
+    const auto test_dir = Common::FS::GetCurrentDir().value_or(".") + "/journaled_savedata_test";
+    Common::FS::DeleteDirRecursively(test_dir);
+    REQUIRE(Common::FS::CreateFullPath(test_dir + "/save/"));
+
+    {
+        const auto vfs = std::make_shared<RealVfsFilesystem>();
+        const auto root = vfs->OpenDirectory(test_dir + "/save", Mode::ReadWrite);
+        const auto journal_file = vfs->CreateFile(test_dir + "/save.journal", Mode::ReadWrite);
+        REQUIRE(root != nullptr);
+        REQUIRE(journal_file != nullptr);
+
+        const auto journal = std::make_shared<SaveDataJournal>(root, journal_file);
+        JournaledSaveDirectory dir{journal};
+
+        const auto file = dir.CreateFile("data.bin");
+        REQUIRE(file != nullptr);
+
+        const std::vector<u8> original(0x10000, 0xAA);
+        REQUIRE(file->WriteBytes(original) == original.size());
+
+        // Writes stay in memory until they are committed.
+        REQUIRE(root->GetFile("data.bin")->GetSize() == 0);
+        REQUIRE(file->ReadAllBytes() == original);
+        REQUIRE(dir.Commit());
+        REQUIRE(root->GetFile("data.bin")->ReadAllBytes() == original);
+
+        // Rewriting the whole file only journals the block that changed.
+        auto modified = original;
+        modified[0x5000] = 0x55;
+        REQUIRE(file->WriteBytes(modified) == modified.size());
+        REQUIRE(dir.Commit());
+        REQUIRE(root->GetFile("data.bin")->ReadAllBytes() == modified);
+
+        const auto snapshots = journal->GetSnapshots();
+        REQUIRE(snapshots.size() == 2);
+        REQUIRE(snapshots[1].journal_size < 0x8000);
+
+        REQUIRE(journal->Revert(snapshots[1].commit_id));
+        REQUIRE(root->GetFile("data.bin")->ReadAllBytes() == original);
+        REQUIRE(file->ReadAllBytes() == original);
+
+        REQUIRE(journal->Revert(snapshots[0].commit_id));
+        REQUIRE(root->GetFile("data.bin") == nullptr);
+        REQUIRE(journal->GetSnapshots().empty());
+    }
+
+    Common::FS::DeleteDirRecursively(test_dir);
+}
+
+} // namespace FileSys
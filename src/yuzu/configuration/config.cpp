@@ -627,6 +627,10 @@ void Config::ReadDataStorageValues() {
         ReadSetting(QStringLiteral("gamecard_current_game"), false).toBool();
     Settings::values.gamecard_path =
         ReadSetting(QStringLiteral("gamecard_path"), QString{}).toString().toStdString();
+    Settings::values.verify_content_on_load =
+        ReadSetting(QStringLiteral("verify_content_on_load"), false).toBool();
+    Settings::values.journal_save_data =
+        ReadSetting(QStringLiteral("journal_save_data"), false).toBool();
 
     qt_config->endGroup();
 }
@@ -1227,6 +1231,9 @@ void Config::SaveDataStorageValues() {
                  false);
     WriteSetting(QStringLiteral("gamecard_path"),
                  QString::fromStdString(Settings::values.gamecard_path), QString{});
+    WriteSetting(QStringLiteral("verify_content_on_load"),
+                 Settings::values.verify_content_on_load, false);
+    WriteSetting(QStringLiteral("journal_save_data"), Settings::values.journal_save_data, false);
 
     qt_config->endGroup();
 }
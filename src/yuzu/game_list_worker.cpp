@@ -2,8 +2,12 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <deque>
+#include <future>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -18,6 +22,7 @@
 #include "core/file_sys/card_image.h"
 #include "core/file_sys/content_archive.h"
 #include "core/file_sys/control_metadata.h"
+#include "core/file_sys/game_file_index.h"
 #include "core/file_sys/mode.h"
 #include "core/file_sys/nca_metadata.h"
 #include "core/file_sys/patch_manager.h"
@@ -189,9 +194,10 @@ QString FormatPatchNameVersions(const FileSys::PatchManager& patch_manager,
 }
 
 QList<QStandardItem*> MakeGameListEntry(const std::string& path, const std::string& name,
-                                        const std::vector<u8>& icon, Loader::AppLoader& loader,
+                                        const std::vector<u8>& icon, Loader::FileType file_type,
                                         u64 program_id, const CompatibilityList& compatibility_list,
-                                        const FileSys::PatchManager& patch) {
+                                        const FileSys::PatchManager& patch,
+                                        const std::function<QString()>& patch_versions_generator) {
     const auto it = FindMatchingCompatibilityEntry(compatibility_list, program_id);
 
     // The game list uses this as compatibility number for untested games
@@ -200,7 +206,6 @@ QList<QStandardItem*> MakeGameListEntry(const std::string& path, const std::stri
         compatibility = it->second.first;
     }
 
-    const auto file_type = loader.GetFileType();
     const auto file_type_string = QString::fromStdString(Loader::GetFileTypeString(file_type));
 
     QList<QStandardItem*> list{
@@ -213,9 +218,7 @@ QList<QStandardItem*> MakeGameListEntry(const std::string& path, const std::stri
 
     if (UISettings::values.show_add_ons) {
         const auto patch_versions = GetGameListCachedObject(
-            fmt::format("{:016X}", patch.GetTitleID()), "pv.txt", [&patch, &loader] {
-                return FormatPatchNameVersions(patch, loader, loader.IsRomFSUpdatable());
-            });
+            fmt::format("{:016X}", patch.GetTitleID()), "pv.txt", patch_versions_generator);
         list.insert(2, new GameListItem(patch_versions));
     }
 
@@ -275,77 +278,34 @@ void GameListWorker::AddTitlesToGameList(GameListDir* parent_dir) {
             GetMetadataFromControlNCA(patch, *control, icon, name);
         }
 
-        emit EntryReady(MakeGameListEntry(file->GetFullPath(), name, icon, *loader, program_id,
-                                          compatibility_list, patch),
+        emit EntryReady(MakeGameListEntry(file->GetFullPath(), name, icon, loader->GetFileType(),
+                                          program_id, compatibility_list, patch,
+                                          [&patch, &loader] {
+                                              return FormatPatchNameVersions(
+                                                  patch, *loader, loader->IsRomFSUpdatable());
+                                          }),
                         parent_dir);
     }
 }
 
-void GameListWorker::ScanFileSystem(ScanTarget target, const std::string& dir_path,
-                                    unsigned int recursion, GameListDir* parent_dir) {
-    auto& system = Core::System::GetInstance();
-
-    const auto callback = [this, target, recursion, parent_dir,
-                           &system](u64* num_entries_out, const std::string& directory,
-                                    const std::string& virtual_name) -> bool {
+void GameListWorker::CollectGameFiles(const std::string& dir_path, unsigned int recursion,
+                                      std::vector<std::string>& files) {
+    const auto callback = [this, recursion, &files](u64* num_entries_out,
+                                                    const std::string& directory,
+                                                    const std::string& virtual_name) -> bool {
         if (stop_processing) {
             // Breaks the callback loop.
             return false;
         }
 
-        const std::string physical_name = directory + DIR_SEP + virtual_name;
+        std::string physical_name = directory + DIR_SEP + virtual_name;
         const bool is_dir = Common::FS::IsDirectory(physical_name);
         if (!is_dir &&
             (HasSupportedFileExtension(physical_name) || IsExtractedNCAMain(physical_name))) {
-            const auto file = vfs->OpenFile(physical_name, FileSys::Mode::Read);
-            auto loader = Loader::GetLoader(system, file);
-            if (!loader) {
-                return true;
-            }
-
-            const auto file_type = loader->GetFileType();
-            if (file_type == Loader::FileType::Unknown || file_type == Loader::FileType::Error) {
-                return true;
-            }
-
-            u64 program_id = 0;
-            const auto res2 = loader->ReadProgramId(program_id);
-
-            if (target == ScanTarget::FillManualContentProvider) {
-                if (res2 == Loader::ResultStatus::Success && file_type == Loader::FileType::NCA) {
-                    provider->AddEntry(FileSys::TitleType::Application,
-                                       FileSys::GetCRTypeFromNCAType(FileSys::NCA{file}.GetType()),
-                                       program_id, file);
-                } else if (res2 == Loader::ResultStatus::Success &&
-                           (file_type == Loader::FileType::XCI ||
-                            file_type == Loader::FileType::NSP)) {
-                    const auto nsp = file_type == Loader::FileType::NSP
-                                         ? std::make_shared<FileSys::NSP>(file)
-                                         : FileSys::XCI{file}.GetSecurePartitionNSP();
-                    for (const auto& title : nsp->GetNCAs()) {
-                        for (const auto& entry : title.second) {
-                            provider->AddEntry(entry.first.first, entry.first.second, title.first,
-                                               entry.second->GetBaseFile());
-                        }
-                    }
-                }
-            } else {
-                std::vector<u8> icon;
-                [[maybe_unused]] const auto res1 = loader->ReadIcon(icon);
-
-                std::string name = " ";
-                [[maybe_unused]] const auto res3 = loader->ReadTitle(name);
-
-                const FileSys::PatchManager patch{program_id, system.GetFileSystemController(),
-                                                  system.GetContentProvider()};
-
-                emit EntryReady(MakeGameListEntry(physical_name, name, icon, *loader, program_id,
-                                                  compatibility_list, patch),
-                                parent_dir);
-            }
+            files.push_back(std::move(physical_name));
         } else if (is_dir && recursion > 0) {
             watch_list.append(QString::fromStdString(physical_name));
-            ScanFileSystem(target, physical_name, recursion - 1, parent_dir);
+            CollectGameFiles(physical_name, recursion - 1, files);
         }
 
         return true;
@@ -354,11 +314,104 @@ void GameListWorker::ScanFileSystem(ScanTarget target, const std::string& dir_pa
     Common::FS::ForeachDirectoryEntry(nullptr, dir_path, callback);
 }
 
+void GameListWorker::ScanFileSystem(ScanTarget target, const std::vector<std::string>& files,
+                                    GameListDir* parent_dir) {
+    auto& system = Core::System::GetInstance();
+    const bool with_control_data = target == ScanTarget::PopulateGameList;
+
+    // Files are parsed by a bounded window of tasks, while the results are consumed in the order
+    // of the files so that the game list and content provider come out the same on every scan.
+    const std::size_t max_pending = std::max(1U, std::thread::hardware_concurrency());
+    std::deque<std::future<FileSys::GameFileEntry>> pending;
+    std::size_t next = 0;
+
+    // The content provider is not thread-safe, so it is only filled in once all files are parsed.
+    std::vector<FileSys::GameFileEntry> entries;
+
+    for (const auto& physical_name : files) {
+        if (stop_processing) {
+            break;
+        }
+
+        while (next < files.size() && pending.size() < max_pending) {
+            pending.push_back(std::async(std::launch::async, [this, &system, &files, next,
+                                                              with_control_data] {
+                return index->GetEntry(system, vfs, files[next], with_control_data);
+            }));
+            ++next;
+        }
+
+        auto entry = pending.front().get();
+        pending.pop_front();
+
+        if (target == ScanTarget::FillManualContentProvider) {
+            entries.push_back(std::move(entry));
+            continue;
+        }
+
+        if (entry.file_type == Loader::FileType::Unknown ||
+            entry.file_type == Loader::FileType::Error) {
+            continue;
+        }
+
+        const FileSys::PatchManager patch{entry.program_id, system.GetFileSystemController(),
+                                          system.GetContentProvider()};
+
+        // Only open the file again if the add-ons are not cached for the title yet.
+        const auto patch_versions_generator = [this, &system, &physical_name, &patch] {
+            const auto file = vfs->OpenFile(physical_name, FileSys::Mode::Read);
+            const auto loader = file == nullptr ? nullptr : Loader::GetLoader(system, file);
+            if (loader == nullptr) {
+                return QString{};
+            }
+            return FormatPatchNameVersions(patch, *loader, loader->IsRomFSUpdatable());
+        };
+
+        emit EntryReady(MakeGameListEntry(physical_name, entry.name, entry.icon, entry.file_type,
+                                          entry.program_id, compatibility_list, patch,
+                                          patch_versions_generator),
+                        parent_dir);
+    }
+
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        for (const auto& content : entries[i].contents) {
+            provider->AddEntry(
+                content.title_type, content.record_type, content.title_id,
+                FileSys::GameFileIndex::OpenContent(vfs, files[i], entries[i], content));
+        }
+    }
+}
+
 void GameListWorker::run() {
     stop_processing = false;
     provider->ClearAllEntries();
 
-    for (UISettings::GameDir& game_dir : game_dirs) {
+    std::string index_path;
+    if (UISettings::values.cache_game_list) {
+        index_path = Common::FS::GetUserPath(Common::FS::UserPath::CacheDir) + DIR_SEP +
+                     "game_list" + DIR_SEP + "index.bin";
+    }
+    index = std::make_unique<FileSys::GameFileIndex>(std::move(index_path));
+
+    // Every game directory fills the content provider before any game list entry is made, so that
+    // the updates of a game are known while its control data is read, whichever directory they
+    // are in.
+    std::vector<std::vector<std::string>> game_dir_files(game_dirs.size());
+    for (int i = 0; i < game_dirs.size(); ++i) {
+        const auto& game_dir = game_dirs[i];
+        if (game_dir.path == QStringLiteral("SDMC") ||
+            game_dir.path == QStringLiteral("UserNAND") ||
+            game_dir.path == QStringLiteral("SysNAND")) {
+            continue;
+        }
+        watch_list.append(game_dir.path);
+        CollectGameFiles(game_dir.path.toStdString(), game_dir.deep_scan ? 256 : 0,
+                         game_dir_files[i]);
+        ScanFileSystem(ScanTarget::FillManualContentProvider, game_dir_files[i], nullptr);
+    }
+
+    for (int i = 0; i < game_dirs.size(); ++i) {
+        UISettings::GameDir& game_dir = game_dirs[i];
         if (game_dir.path == QStringLiteral("SDMC")) {
             auto* const game_list_dir = new GameListDir(game_dir, GameListItemType::SdmcDir);
             emit DirEntryReady(game_list_dir);
@@ -372,16 +425,17 @@ void GameListWorker::run() {
             emit DirEntryReady(game_list_dir);
             AddTitlesToGameList(game_list_dir);
         } else {
-            watch_list.append(game_dir.path);
             auto* const game_list_dir = new GameListDir(game_dir);
             emit DirEntryReady(game_list_dir);
-            ScanFileSystem(ScanTarget::FillManualContentProvider, game_dir.path.toStdString(),
-                           game_dir.deep_scan ? 256 : 0, game_list_dir);
-            ScanFileSystem(ScanTarget::PopulateGameList, game_dir.path.toStdString(),
-                           game_dir.deep_scan ? 256 : 0, game_list_dir);
+            ScanFileSystem(ScanTarget::PopulateGameList, game_dir_files[i], game_list_dir);
         }
     }
 
+    // A cancelled scan has not seen every file, so keep the previous index.
+    if (!stop_processing) {
+        index->Save();
+    }
+
     emit Finished(watch_list);
 }
 
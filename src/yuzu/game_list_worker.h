@@ -9,6 +9,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <QList>
 #include <QObject>
@@ -22,6 +23,7 @@
 class QStandardItem;
 
 namespace FileSys {
+class GameFileIndex;
 class NCA;
 class VfsFilesystem;
 } // namespace FileSys
@@ -70,13 +72,20 @@ private:
         PopulateGameList,
     };
 
-    void ScanFileSystem(ScanTarget target, const std::string& dir_path, unsigned int recursion,
+    /// Appends the supported game files below dir_path to files, and the directories searched to
+    /// the watch list.
+    void CollectGameFiles(const std::string& dir_path, unsigned int recursion,
+                          std::vector<std::string>& files);
+
+    /// Parses the given game files on a pool of threads, handling the results in order.
+    void ScanFileSystem(ScanTarget target, const std::vector<std::string>& files,
                         GameListDir* parent_dir);
 
     std::shared_ptr<FileSys::VfsFilesystem> vfs;
     FileSys::ManualContentProvider* provider;
     QVector<UISettings::GameDir>& game_dirs;
     const CompatibilityList& compatibility_list;
+    std::unique_ptr<FileSys::GameFileIndex> index;
 
     QStringList watch_list;
     std::atomic_bool stop_processing;
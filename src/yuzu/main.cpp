@@ -1864,6 +1864,7 @@ void GMainWindow::OnMenuInstallToNAND() {
     QStringList new_files{};         // Newly installed files that do not yet exist in the NAND
     QStringList overwritten_files{}; // Files that overwrote those existing in the NAND
     QStringList failed_files{};      // Files that failed to install due to errors
+    QStringList corrupted_files{};   // Files whose contents did not match their metadata
 
     ui.action_Install_File_NAND->setEnabled(false);
 
@@ -1909,6 +1910,9 @@ void GMainWindow::OnMenuInstallToNAND() {
         case InstallResult::Failure:
             failed_files.append(QFileInfo(file).fileName());
             break;
+        case InstallResult::HashMismatch:
+            corrupted_files.append(QFileInfo(file).fileName());
+            break;
         }
 
         --remaining;
@@ -1923,7 +1927,10 @@ void GMainWindow::OnMenuInstallToNAND() {
              ? QString{}
              : tr("%n file(s) were overwritten\n", "", overwritten_files.size())) +
         (failed_files.isEmpty() ? QString{}
-                                : tr("%n file(s) failed to install\n", "", failed_files.size()));
+                                : tr("%n file(s) failed to install\n", "", failed_files.size())) +
+        (corrupted_files.isEmpty()
+             ? QString{}
+             : tr("%n file(s) are corrupted and were not installed\n", "", corrupted_files.size()));
 
     QMessageBox::information(this, tr("Install Results"), install_results);
     Common::FS::DeleteDirRecursively(Common::FS::GetUserPath(Common::FS::UserPath::CacheDir) +
@@ -1932,32 +1939,35 @@ void GMainWindow::OnMenuInstallToNAND() {
     ui.action_Install_File_NAND->setEnabled(true);
 }
 
-InstallResult GMainWindow::InstallNSPXCI(const QString& filename) {
-    const auto qt_raw_copy = [this](const FileSys::VirtualFile& src,
-                                    const FileSys::VirtualFile& dest, std::size_t block_size) {
-        if (src == nullptr || dest == nullptr) {
+bool GMainWindow::InstallCopy(const FileSys::VirtualFile& src, const FileSys::VirtualFile& dest,
+                              std::size_t block_size) {
+    // The progress bar counts the blocks of 0x1000 bytes copied.
+    std::size_t uncounted_size = 0;
+    const auto progress = [this, &uncounted_size](std::size_t size) {
+        if (install_progress->wasCanceled()) {
             return false;
         }
-        if (!dest->Resize(src->GetSize())) {
-            return false;
-        }
-
-        std::array<u8, 0x1000> buffer{};
-
-        for (std::size_t i = 0; i < src->GetSize(); i += buffer.size()) {
-            if (install_progress->wasCanceled()) {
-                dest->Resize(0);
-                return false;
-            }
-
+        for (uncounted_size += size; uncounted_size >= 0x1000; uncounted_size -= 0x1000) {
             emit UpdateInstallProgress();
-
-            const auto read = src->Read(buffer.data(), buffer.size(), i);
-            dest->Write(buffer.data(), read, i);
         }
         return true;
     };
 
+    if (!FileSys::VfsPipelinedCopyWithProgress(src, dest, block_size, progress)) {
+        if (dest != nullptr) {
+            dest->Resize(0);
+        }
+        return false;
+    }
+    return true;
+}
+
+InstallResult GMainWindow::InstallNSPXCI(const QString& filename) {
+    const auto qt_raw_copy = [this](const FileSys::VirtualFile& src,
+                                    const FileSys::VirtualFile& dest, std::size_t block_size) {
+        return InstallCopy(src, dest, block_size);
+    };
+
     std::shared_ptr<FileSys::NSP> nsp;
     if (filename.endsWith(QStringLiteral("nsp"), Qt::CaseInsensitive)) {
         nsp = std::make_shared<FileSys::NSP>(
@@ -1981,6 +1991,8 @@ InstallResult GMainWindow::InstallNSPXCI(const QString& filename) {
         return InstallResult::Success;
     } else if (res == FileSys::InstallResult::OverwriteExisting) {
         return InstallResult::Overwrite;
+    } else if (res == FileSys::InstallResult::ErrorHashMismatch) {
+        return InstallResult::HashMismatch;
     } else {
         return InstallResult::Failure;
     }
@@ -1989,27 +2001,7 @@ InstallResult GMainWindow::InstallNSPXCI(const QString& filename) {
 InstallResult GMainWindow::InstallNCA(const QString& filename) {
     const auto qt_raw_copy = [this](const FileSys::VirtualFile& src,
                                     const FileSys::VirtualFile& dest, std::size_t block_size) {
-        if (src == nullptr || dest == nullptr) {
-            return false;
-        }
-        if (!dest->Resize(src->GetSize())) {
-            return false;
-        }
-
-        std::array<u8, 0x1000> buffer{};
-
-        for (std::size_t i = 0; i < src->GetSize(); i += buffer.size()) {
-            if (install_progress->wasCanceled()) {
-                dest->Resize(0);
-                return false;
-            }
-
-            emit UpdateInstallProgress();
-
-            const auto read = src->Read(buffer.data(), buffer.size(), i);
-            dest->Write(buffer.data(), read, i);
-        }
-        return true;
+        return InstallCopy(src, dest, block_size);
     };
 
     const auto nca =
@@ -2068,6 +2060,8 @@ InstallResult GMainWindow::InstallNCA(const QString& filename) {
         return InstallResult::Success;
     } else if (res == FileSys::InstallResult::OverwriteExisting) {
         return InstallResult::Overwrite;
+    } else if (res == FileSys::InstallResult::ErrorHashMismatch) {
+        return InstallResult::HashMismatch;
     } else {
         return InstallResult::Failure;
     }
@@ -64,6 +64,7 @@ enum class InstallResult {
     Success,
     Overwrite,
     Failure,
+    HashMismatch,
 };
 
 enum class ReinitializeKeyBehavior {
@@ -252,6 +253,8 @@ private:
     std::optional<u64> SelectRomFSDumpTarget(const FileSys::ContentProvider&, u64 program_id);
     InstallResult InstallNSPXCI(const QString& filename);
     InstallResult InstallNCA(const QString& filename);
+    bool InstallCopy(const FileSys::VirtualFile& src, const FileSys::VirtualFile& dest,
+                     std::size_t block_size);
     void MigrateConfigFiles();
     void UpdateWindowTitle(const std::string& title_name = {},
                            const std::string& title_version = {});
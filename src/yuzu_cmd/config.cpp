@@ -341,6 +341,10 @@ void Config::ReadValues() {
     Settings::values.gamecard_current_game =
         sdl2_config->GetBoolean("Data Storage", "gamecard_current_game", false);
     Settings::values.gamecard_path = sdl2_config->Get("Data Storage", "gamecard_path", "");
+    Settings::values.verify_content_on_load =
+        sdl2_config->GetBoolean("Data Storage", "verify_content_on_load", false);
+    Settings::values.journal_save_data =
+        sdl2_config->GetBoolean("Data Storage", "journal_save_data", false);
 
     // System
     Settings::values.use_docked_mode.SetValue(
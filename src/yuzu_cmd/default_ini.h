@@ -272,6 +272,15 @@ gamecard_current_game =
 # If 'gamecard_current_game' is 1 this setting is irrelevant
 gamecard_path =
 
+# Whether to check the hashes of the loaded game's contents in the background
+# 1: Yes, 0 (default): No
+verify_content_on_load =
+
+# Whether to keep game save data changes in memory until the game commits them, writing only the
+# changed blocks and journaling them so that earlier commits can be restored
+# 1: Yes, 0 (default): No
+journal_save_data =
+
 [System]
 # Whether the system is docked
 # 1: Yes, 0 (default): No